@@ -0,0 +1,202 @@
+// Expressions of the LCM pass and the table that numbers them. Included by
+// src/LCMPass.cpp and by the ExprTable microbenchmark in tests/.
+#ifndef LCM_EXPRTABLE_H
+#define LCM_EXPRTABLE_H
+
+#include "llvm/ADT/Hashing.h" // hashing expressions for the interning table
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Instructions.h"
+#include <algorithm>
+#include <vector>
+
+namespace lcm {
+
+using namespace llvm;
+
+/* Expression */
+// Instructions with the same opcode, type, operands, aux and flags compute
+// the same value wherever they are, and share one expression. Any other
+// instruction that is not lexical (see isLexical) is an expression of its
+// own, and a store is identified by its address as well: dest is part of
+// the identity.
+struct Expression {
+    Instruction* I; // the first instruction seen for the expression
+    Value* dest; // the stored-to address, the instruction itself, or nullptr if lexical
+    unsigned opcode;
+    Type* type;
+    uintptr_t aux; // predicate of a compare, source element type of a GEP
+    unsigned flags; // nsw, nuw, exact, inbounds, fast-math flags
+    SmallVector<Value*, 4> operands;
+    unsigned hash; // computed once in InstrToExpr()
+
+	// https://stackoverflow.com/questions/7204283/how-can-i-use-a-struct-as-key-in-a-stdmap
+	bool operator<(const Expression &x) const {
+		if (x.dest != dest)
+			return (x.dest < dest);
+		if (x.opcode != opcode) 
+			return (x.opcode < opcode);
+		if (x.type != type)
+			return (x.type < type);
+		if (x.aux != aux)
+			return (x.aux < aux);
+		if (x.flags != flags)
+			return (x.flags < flags);
+		if (x.operands.size() != operands.size()) 
+			return (x.operands.size() < operands.size());
+
+		int n = x.operands.size();
+		for(int i=0; i<n; i++) {
+			if (x.operands[i] != operands[i])
+				return (x.operands[i] < operands[i]);
+		}
+		return false;
+	}
+	bool operator==(const Expression &x) const {
+		if (x.hash != hash)
+			return false;
+		if (x.dest != dest)
+			return false;
+		if (x.opcode != opcode) 
+			return false;
+		if (x.type != type)
+			return false;
+		if (x.aux != aux || x.flags != flags)
+			return false;
+		if (x.operands.size() != operands.size()) 
+			return false;
+
+		int n = x.operands.size();
+		for(int i=0; i<n; i++) {
+			if (x.operands[i] != operands[i])
+				return false;
+		}
+		return true;
+	}
+};
+
+inline unsigned hashExpr(const Expression &expr) {
+	return (unsigned)hash_combine(expr.dest, expr.opcode, expr.type, expr.aux, expr.flags,
+		hash_combine_range(expr.operands.begin(), expr.operands.end()));
+}
+
+// Whether I computes a value from its operands alone, so that every
+// instruction equal to it (see Expression) computes the same value. Memory
+// accesses are not: with no alias information, any write to memory may
+// change what a load reads (see ValueIndex::memory). PHIs depend on their
+// block, freeze and EH pads on the instruction itself, and the remaining
+// opcodes have state that aux does not hold.
+inline bool isLexical(Instruction* I) {
+	return !I->mayReadOrWriteMemory() && !isa<PHINode>(I) && !isa<FreezeInst>(I) && !I->isEHPad() &&
+		!isa<ExtractValueInst>(I) && !isa<InsertValueInst>(I) && !isa<ShuffleVectorInst>(I);
+}
+
+// Ref. https://www.cs.toronto.edu/~pekhimenko/courses/cscd70-w18/docs/Tutorial%202%20-%20Intro%20to%20LLVM%20(Cont).pdf
+// User-Use-Usee Design:
+// Important: class hierarchies - Value -> User -> Instruction
+// An User keeps track of a list of Values that it uses as Operands
+inline Expression InstrToExpr(Instruction* I) {
+	// https://llvm.org/doxygen/classllvm_1_1Instruction.html
+	// errs() << *I << "\n";
+	Expression expr;
+	expr.I = I;
+	expr.opcode = I->getOpcode();
+
+	if (isa<StoreInst>(*I))
+		expr.dest = I->getOperand(1);
+	else if (isLexical(I))
+		expr.dest = nullptr; // any equal instruction is the same expression
+	else
+		expr.dest = I; // the destination value is the instruction itself
+	expr.aux = 0;
+	if (auto* C = dyn_cast<CmpInst>(I))
+		expr.aux = C->getPredicate();
+	else if (auto* G = dyn_cast<GetElementPtrInst>(I))
+		expr.aux = reinterpret_cast<uintptr_t>(G->getSourceElementType());
+	expr.flags = I->getRawSubclassOptionalData();
+
+	// https://stackoverflow.com/questions/44946645/traversal-of-llvm-operands
+	for (unsigned i = 0; i < I->getNumOperands(); ++i) {
+		if (isa<StoreInst>(*I) && i == 1) continue; // Skip the destination operand
+		Value* op = I->getOperand(i);
+		expr.operands.push_back(op);
+	}
+	expr.type = I->getType();
+	expr.hash = hashExpr(expr);
+	// errs() << expr.dest << " = " << " " << I->getOpcodeName() << " ";
+	return expr;
+}
+
+/* ExprTable */
+// Interns expressions into dense IDs (= bit positions in the BitVectors).
+// Open addressing with linear probing over a power-of-two slot array;
+// the expressions themselves are stored contiguously in ID order.
+struct ExprTable {
+    static constexpr unsigned EMPTY = ~0u;
+
+    SmallVector<Expression, 128> exprs; // ID -> Expression
+    std::vector<unsigned> slots;        // hash slot -> ID, EMPTY if unused
+
+    void clear() {
+        exprs.clear();
+        slots.assign(64, EMPTY);
+    }
+
+    unsigned size() const { return exprs.size(); }
+    Expression& operator[](unsigned id) { return exprs[id]; }
+    const Expression& operator[](unsigned id) const { return exprs[id]; }
+
+    // ID of expr, or EMPTY if it has not been interned.
+    unsigned lookup(const Expression &expr) const {
+        unsigned mask = slots.size() - 1;
+        for (unsigned s = expr.hash & mask; ; s = (s + 1) & mask) {
+            unsigned id = slots[s];
+            if (id == EMPTY || exprs[id] == expr)
+                return id;
+        }
+    }
+
+    // ID of expr, assigning the next free ID if it is new.
+    unsigned insert(const Expression &expr) {
+        if ((exprs.size() + 1) * 4 > slots.size() * 3)
+            grow();
+        unsigned mask = slots.size() - 1;
+        unsigned s = expr.hash & mask;
+        for (; slots[s] != EMPTY; s = (s + 1) & mask) {
+            if (exprs[slots[s]] == expr)
+                return slots[s];
+        }
+        slots[s] = exprs.size();
+        exprs.push_back(expr);
+        return slots[s];
+    }
+
+    // Renumber: the expression with ID order[k] gets ID k. Expressions not
+    // in order are dropped.
+    void reorder(ArrayRef<unsigned> order) {
+        SmallVector<Expression, 128> old;
+        old.swap(exprs);
+        for (unsigned id : order)
+            exprs.push_back(std::move(old[id]));
+        slots.assign(slots.size(), EMPTY);
+        rehash();
+    }
+
+    void grow() {
+        slots.assign(std::max<size_t>(64, slots.size() * 2), EMPTY);
+        rehash();
+    }
+
+    void rehash() {
+        unsigned mask = slots.size() - 1;
+        for (unsigned id = 0; id < exprs.size(); id++) {
+            unsigned s = exprs[id].hash & mask;
+            while (slots[s] != EMPTY)
+                s = (s + 1) & mask;
+            slots[s] = id;
+        }
+    }
+};
+
+} // namespace lcm
+
+#endif // LCM_EXPRTABLE_H
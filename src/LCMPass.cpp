@@ -1,822 +1,2656 @@
-// This project is greatly aided by ChatGPT for LLVM syntax usage. 
-// You can see the process here at this link: 
-// https://chatgpt.com/share/67585d68-91e4-8003-b8bc-14576da175ad
-
-#include "llvm/Pass.h"
-#include "llvm/Passes/PassBuilder.h"
-#include "llvm/Passes/PassPlugin.h"
-#include "llvm/Support/raw_ostream.h"
-
-// Ref.: https://stackoverflow.com/questions/21708209/get-predecessors-for-basicblock-in-llvm
-// Get a BB's predecessors
-#include "llvm/IR/CFG.h"
-#include "llvm/ADT/SmallVector.h"
-#include "llvm/ADT/BitVector.h" // set operation
-#include "llvm/ADT/DenseMap.h" // mapping expression to bitvector position
-#include "llvm/ADT/DepthFirstIterator.h"
-#include "llvm/ADT/PostOrderIterator.h"
-#include <map> // DenseMap is hard to use...
-#include <string>
-#include <queue>
-
-
-typedef std::pair<llvm::BasicBlock*, llvm::BasicBlock*> BBpair;
-
-using namespace llvm;
-
-namespace {
-
-/* Expression */
-struct Expression {
-    Instruction* I;
-    Value* dest;
-    unsigned opcode;
-    SmallVector<Value*, 4> operands;
-
-	// https://stackoverflow.com/questions/7204283/how-can-i-use-a-struct-as-key-in-a-stdmap
-	bool operator<(const Expression &x) const {
-		if (x.dest != dest)
-			return (x.dest < dest);
-		if (x.opcode != opcode) 
-			return (x.opcode < opcode);
-		if (x.operands.size() != operands.size()) 
-			return (x.operands.size() < operands.size());
-
-		int n = x.operands.size();
-		for(int i=0; i<n; i++) {
-			if (x.operands[i] != operands[i])
-				return (x.operands[i] < operands[i]);
-		}
-		return false;
-	}
-	bool operator==(const Expression &x) const {
-		if (x.dest != dest)
-			return false;
-		if (x.opcode != opcode) 
-			return false;
-		if (x.operands.size() != operands.size()) 
-			return false;
-
-		int n = x.operands.size();
-		for(int i=0; i<n; i++) {
-			if (x.operands[i] != operands[i])
-				return false;
-		}
-		return true;
-	}
-};
-
-// Ref. https://www.cs.toronto.edu/~pekhimenko/courses/cscd70-w18/docs/Tutorial%202%20-%20Intro%20to%20LLVM%20(Cont).pdf
-// User-Use-Usee Design:
-// Important: class hierarchies - Value -> User -> Instruction
-// An User keeps track of a list of Values that it uses as Operands
-Expression InstrToExpr(Instruction* I) {
-	// https://llvm.org/doxygen/classllvm_1_1Instruction.html
-	// errs() << *I << "\n";
-	Expression expr;
-	expr.I = I;
-	expr.opcode = I->getOpcode();
-
-	if (isa<StoreInst>(*I))
-		expr.dest = I->getOperand(1);
-	else
-		expr.dest = I; // the destination value is the instruction itself
-
-	// https://stackoverflow.com/questions/44946645/traversal-of-llvm-operands
-	for (unsigned i = 0; i < I->getNumOperands(); ++i) {
-		if (isa<StoreInst>(*I) && i == 1) continue; // Skip the destination operand
-		Value* op = I->getOperand(i);
-		expr.operands.push_back(op);
-	}
-	// errs() << expr.dest << " = " << " " << I->getOpcodeName() << " ";
-	return expr;
-}
-
-bool ignore_instr(Instruction* I) {
-	return (isa<AllocaInst>(*I) || I->isTerminator() || isa<CallInst>(*I));
-	// terminator: branch, return
-}
-
-/* BasicBlockInfo */
-struct BasicBlockInfo {
-	BasicBlock* B;
-	SmallVector<Expression> exprs;
-
-	BitVector Exprs;
-	BitVector DEExpr;
-	BitVector UEExpr;
-	BitVector ExprKill;
-	BitVector AvailOut;
-	BitVector AvailIn;
-	BitVector AntOut;
-	BitVector AntIn;
-
-	BitVector LaterIn;
-	BitVector Delete;
-
-	bool operator==(const BasicBlockInfo &x) const {
-		return (B == x.B);
-	}
-	bool operator<(const BasicBlockInfo &x) const {
-		return (B < x.B);
-	}
-
-};
-
-void initBasicBlockInfoBitVector(BasicBlockInfo* b, unsigned n) {
-	b->Exprs.resize(n); b->Exprs.reset();
-	b->ExprKill.resize(n); b->ExprKill.reset();
-	b->DEExpr.resize(n); b->DEExpr.reset();
-	b->UEExpr.resize(n); b->UEExpr.reset();
-
-	b->AvailOut.resize(n); b->AvailOut.reset();
-
-	b->AvailIn.resize(n); b->AvailIn.reset();
-	b->AntOut.resize(n); b->AntOut.reset();
-	b->AntIn.resize(n); b->AntIn.reset();
-
-	b->LaterIn.resize(n); b->LaterIn.reset();
-	b->Delete.resize(n); b->Delete.reset();
-}
-
-/* EdgeInfo */
-struct EdgeInfo {
-	BBpair edge;
-	BasicBlock* start;
-	BasicBlock* end;
-
-	BitVector Earliest;
-	BitVector Later;
-	BitVector Insert;
-
-	BasicBlock* InsertBlock;
-
-	bool operator==(const EdgeInfo &x) const { return (edge == x.edge); }
-	bool operator<(const EdgeInfo &x) const { return (edge < x.edge); }
-};
-void initEdgeInfoBitVector(EdgeInfo* edgeinfo, BBpair pair, unsigned n) {
-	edgeinfo->start = pair.first; edgeinfo->end = pair.second;
-	edgeinfo->Earliest.resize(n); edgeinfo->Earliest.reset();
-	edgeinfo->Later.resize(n); edgeinfo->Later.reset();
-	edgeinfo->Insert.resize(n); edgeinfo->Insert.reset();
-	edgeinfo->InsertBlock = NULL;
-}
-
-/* Helper functions */
-
-void print_value(Value v) {
-	if (v.hasName())
-		errs() << v.getName();
-	else
-		errs() << v;
-}
-
-void print_bitvector(BitVector bv) {
-	int n = bv.size();
-	for(int i=0;i<n;i++) {
-		errs() << bv[i];
-		if (!((i+1)%10))
-			errs() << " ";
-	}
-	errs() <<" ("<<n<< ")\n";
-}
-
-void printBasicBlockInfo(BasicBlockInfo* bbinfo) {
-	errs() << "> Block:\t";
-	errs() << *(bbinfo->B);
-	errs() << "Exprs:\t\t";
-	print_bitvector(bbinfo->Exprs);
-	errs() << "ExprKill:\t";
-	print_bitvector(bbinfo->ExprKill);
-	errs() << "DEExpr:\t\t";
-	print_bitvector(bbinfo->DEExpr);
-	errs() << "UEExpr:\t\t";
-	print_bitvector(bbinfo->UEExpr);
-
-	errs() << "AvailOut:\t";
-	print_bitvector(bbinfo->AvailOut);
-	errs() << "AvailIn:\t";
-	print_bitvector(bbinfo->AvailIn);
-	errs() << "AntOut:\t\t";
-	print_bitvector(bbinfo->AntOut);
-	errs() << "AntIn:\t\t";
-	print_bitvector(bbinfo->AntIn);
-
-	errs() << "LaterIn:\t";
-	print_bitvector(bbinfo->LaterIn);
-	errs() << "Delete:\t\t";
-	print_bitvector(bbinfo->Delete);
-}
-
-void print_edges(SmallVector<BBpair, 8> edges) {
-	for(auto &pair : edges) {
-		errs() << "(";
-		pair.first->printAsOperand(errs(), false);
-		errs() << ",";
-		pair.second->printAsOperand(errs(), false);
-		errs() << ") ";
-	}
-	errs() << "\n";
-}
-
-void printEdgeInfo(EdgeInfo* edgeinfo) {
-	errs() << "(";
-	edgeinfo->edge.first->printAsOperand(errs(), false);
-	errs() << ",";
-	edgeinfo->edge.second->printAsOperand(errs(), false);
-	errs() << ")\n";
-
-	errs() << "Earliest:\t";
-	print_bitvector(edgeinfo->Earliest);
-	errs() << "Later:\t\t";
-	print_bitvector(edgeinfo->Later);
-	errs() << "Insert:\t\t";
-	print_bitvector(edgeinfo->Insert);
-	errs() << "\n";
-}
-
-struct LCMPass : public PassInfoMixin<LCMPass> {
-
-    // Expression related stuff
-    std::map<Expression, unsigned> exprmap; // Expression -> # of expression in BitVectors
-    SmallVector<Expression, 128> inv_exprmap; // # of expression in BitVectors -> Expression
-
-    // CFG related stuff
-    SmallVector<BBpair, 8> edges;
-    std::map<BasicBlock*, BasicBlockInfo> blockmap;
-    std::map<BBpair, EdgeInfo> edgemap;
-
-    void init(Function &F) {
-        exprmap.clear();
-        inv_exprmap.clear();
-        blockmap.clear();
-        edgemap.clear();
-    }
-
-    void buildNodes(Function &F) {
-        // first pass: build CFG and collect all expressions
-        int n = 0;
-        for (auto &B : F) {
-            BasicBlockInfo bbinfo;
-            bbinfo.B = &B;
-
-            for(auto &I : B) {
-                // Filter out non store/load or binary operator instructions
-                if (ignore_instr(&I))
-                    continue;
-
-                Expression expr = InstrToExpr(&I);
-                bbinfo.exprs.push_back(expr);
-                if (exprmap.find(expr) == exprmap.end()) {
-                    exprmap.insert(std::make_pair(expr, n++));
-                    inv_exprmap.push_back(expr);
-                }
-            }
-            blockmap.insert(std::make_pair(&B, bbinfo));
-        }
-
-        // Second pass: build BitVectors
-        for (auto &B : F) {
-            initBasicBlockInfoBitVector(&(blockmap[&B]), n);
-
-            for (auto &expr : blockmap[&B].exprs) {
-                unsigned idx = exprmap[expr];
-                blockmap[&B].Exprs[idx] = 1;
-            }
-        }
-    }
-
-    void buildEdges(Function &F) {
-        for(auto &B : F) {
-            if (succ_empty(&B))
-                continue;
-
-            for (BasicBlock* succ : successors(&B))
-                edges.push_back(std::make_pair(&B, succ));
-            // add edge (B, succ)
-        }
-
-        for (auto &edge : edges) {
-            EdgeInfo edgeinfo;
-            edgeinfo.edge = edge; // pair of BasicBlock*; do not use &edge !!!
-            initEdgeInfoBitVector(&edgeinfo, edge, exprmap.size());
-            edgemap[edge] = edgeinfo;
-        }
-    }
-
-
-    void buildExprKill(BasicBlockInfo* bbinfo) {
-        // For each block
-        // Naive O(N^2 * C) method; C = max. operand of an instruction
-
-        // Initialization: empty set
-        bbinfo->ExprKill.reset();
-
-        for (auto &pair : exprmap) {
-            const Expression* expr = &(pair.first);
-            unsigned bit = exprmap[*expr];
-            Instruction* I = expr->I;
-
-            for (auto &op : expr->operands) {
-                int n = exprmap.size();
-
-                for (int i=0; i<n; i++) {
-                    // Pick expression from BitVector
-                    if (!bbinfo->Exprs[i])
-                        continue;
-
-                    Expression* definition = &(inv_exprmap[i]);
-                    if (definition->dest == op) {
-                        bbinfo->ExprKill[bit] = 1;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-
-    void buildDEExpr(BasicBlockInfo* bbinfo) {
-        // For each block
-        // "Not changed after last use"
-
-		// the expression is evaluated AFTER (re)definition within the same block, 
-		// and its operands are not redefined afterwards
-
-        bbinfo->DEExpr.reset();
-        bbinfo->DEExpr |= bbinfo->Exprs;
-
-        std::map<Value*, unsigned> defined;
-        defined.clear();
-
-        BitVector used;
-        used.resize(exprmap.size());
-        used.reset();
-
-        for (auto it = bbinfo->B->rbegin(); it != bbinfo->B->rend(); ++it) {
-            Instruction &I = *it;
-            if (ignore_instr(&I))
-                continue;
-            Expression expr = InstrToExpr(&I);
-            unsigned cur_bit = exprmap[expr];
-
-            for (auto &op : expr.operands) {
-                if (defined.find(op) != defined.end())  {
-                    // operand defined before in this block
-                    bbinfo->DEExpr[cur_bit] = 0;
-                }
-            }
-            defined.insert(std::make_pair(expr.dest, 1));
-        }
-    }
-
-    void buildUEExpr(BasicBlockInfo* bbinfo) {
-        // For each block
-        // "Not used after last change"
-
-		// the expression is evaluated BEFORE any (re)definition within the same block, 
-		// and its operands are not redefined before
-
-        bbinfo->UEExpr.reset();
-        bbinfo->UEExpr |= bbinfo->Exprs;
-
-        std::map<Value*, unsigned> defined;
-        defined.clear();
-
-        for (auto it = bbinfo->B->begin(); it != bbinfo->B->end(); ++it) {
-            Instruction &I = *it;
-            if (ignore_instr(&I))
-                continue;
-            Expression expr = InstrToExpr(&I);
-            unsigned cur_bit = exprmap[expr];
-
-            for (auto &op : expr.operands) {
-                if (defined.find(op) != defined.end()) 
-                    // operand defined afterwards in this block
-                    bbinfo->UEExpr[cur_bit] = 0;
-            }
-            defined.insert(std::make_pair(expr.dest, 1));
-        }
-    }
-
-    void buildAvailExpr(Function &F) {
-        // Forward flow
-        // AvailOut = DEExpr + (AvailIn - ExprKill)
-        // AvailIn(n) = INTERSECT(AvailOut(m)) for m in preds(n)
-
-        std::queue<BasicBlock*> q;
-        std::map<BasicBlock*, bool> visited;
-        visited.clear();
-        for (auto &B : F) {
-            visited.insert(std::make_pair(&B, false));
-        }
-
-        BasicBlock* entryBlock = &(F.getEntryBlock());
-        q.push(entryBlock);
-        visited[entryBlock] = true;
-
-        // Init: AvailIn(n_0) = {}, AvailIn(n) = {all} for n != n0
-        for (auto &B : F) {
-            BasicBlockInfo* bbinfo = &(blockmap[&B]);
-            bbinfo->AvailIn.reset();
-            bbinfo->AvailIn.flip();
-            bbinfo->AvailOut.reset();
-            bbinfo->AvailOut.flip();
-        }
-        blockmap[entryBlock].AvailIn.reset();
-
-        int changed = 0;
-        int n = exprmap.size();
-        // worklist: push in successors every time -> guarantee that each block will
-        // be traversed after each of predecessor at least once
-        while(!q.empty()) {
-            BasicBlock* p = q.front();
-            q.pop();
-            visited[p] = false;
-            changed = 0;
-
-            BitVector old(blockmap[p].AvailOut);
-
-            // blockmap[p].AvailOut |= (blockmap[p].DEExpr | (blockmap[p].AvailIn & negExprkill));
-            blockmap[p].AvailOut.reset();
-            blockmap[p].AvailOut |= blockmap[p].DEExpr;
-            BitVector negExprkill = blockmap[p].ExprKill;
-            negExprkill.flip();
-            BitVector tmp = blockmap[p].AvailIn;
-            tmp &= negExprkill;
-            blockmap[p].AvailOut |= tmp;
-
-            changed |= (old != blockmap[p].AvailOut);
-
-            for(auto succ : successors(p)) {
-                BitVector old(blockmap[succ].AvailIn);
-                blockmap[succ].AvailIn &= blockmap[p].AvailOut;
-
-                if ((changed | old != blockmap[succ].AvailIn) \
-					 && !visited[succ]) {
-					q.push(succ);
-					visited[succ] = true;
-                }
-            }
-        }
-    }
-
-    void buildAnticiExpr(Function &F) {
-        // Backward flow
-        // AntIn = UEExpr + (AntOut - ExprKill)
-        // AntOut(n) = INTERSECT(AntIn(m)) for m in succs(n), for n != n_f]
-
-        std::queue<BasicBlock*> q;
-        std::map<BasicBlock*, bool> visited;
-        visited.clear();
-        for (auto &B : F) {
-            visited.insert(std::make_pair(&B, false));
-        }
-
-        SmallVector<BasicBlock*, 4> leafNodes;
-        for (auto &B : F) {
-            if (succ_empty(&B)) {
-                q.push(&B);
-                leafNodes.push_back(&B);
-                visited[&B] = true;
-            }
-        }
-
-        // Init: AntOut(n_f) = {}, AntOut(n) = {all} for n != n_f
-        for (auto &B : F) {
-            BasicBlockInfo* bbinfo = &(blockmap[&B]);
-            bbinfo->AntOut.reset();
-            bbinfo->AntOut.flip();
-            bbinfo->AntIn.reset();
-            bbinfo->AntIn.flip();
-        }
-        for (auto it : leafNodes) {
-            BasicBlockInfo* bbinfo = &(blockmap[it]);
-            bbinfo->AntOut.reset();
-        }
-
-        int changed = 0;
-        int n = exprmap.size();
-        // worklist: push in predecessors every time -> guarantee that each block will
-        // be traversed after each of successors at least once
-        while(!q.empty()) {
-            BasicBlock* p = q.front();
-            q.pop();
-            visited[p] = false;
-            changed = 0;
-
-            BitVector old(blockmap[p].AntIn);
-
-            blockmap[p].AntIn.reset();
-            // blockmap[p].AntIn |= (blockmap[p].UEExpr | (blockmap[p].AntOut & negExprkill));
-            blockmap[p].AntIn |= blockmap[p].UEExpr;
-            BitVector negExprkill = blockmap[p].ExprKill;
-            negExprkill.flip();
-            BitVector tmp(blockmap[p].AntOut);
-            tmp &= negExprkill;
-            blockmap[p].AntIn |= tmp;
-
-            changed |= (old != blockmap[p].AntIn);
-
-			if (pred_empty(p))
-				continue;
-            
-            for(BasicBlock *pred : predecessors(p)) {
-                BitVector old(blockmap[pred].AntOut);
-                blockmap[pred].AntOut &= blockmap[p].AntIn;
-                
-                if ((changed | (old != blockmap[pred].AntOut)) \
-					 && !visited[pred]) {
-					q.push(pred);
-					visited[pred] = true;
-                }
-            }
-        }
-    }
-
-    void buildEarliest(Function &F) {
-        // For each edge
-        // Earliest(i, j) = (AntIn(j) - AvailOut(i)) & (ExprKill(i) + ~AntOut(i))
-        for (auto &edge : edges) {
-            EdgeInfo *edgeinfo = &(edgemap[edge]);
-            BasicBlock* i = edgeinfo->start;
-            BasicBlock* j = edgeinfo->end;
-            
-            BitVector tmp1(blockmap[j].AntIn);
-            BitVector negAvailOut_i(blockmap[i].AvailOut);
-            negAvailOut_i.flip();
-            tmp1 &= negAvailOut_i;
-
-            BitVector tmp2(blockmap[i].ExprKill);
-            BitVector negAntOut_i(blockmap[i].AntOut);
-            negAntOut_i.flip();
-            tmp2 |= negAntOut_i;
-            
-            // print_bitvector(tmp1);
-            // print_bitvector(tmp2);
-            // printEdgeInfo(edgeinfo);
-
-            edgeinfo->Earliest.reset();
-            edgeinfo->Earliest |= tmp1;
-            edgeinfo->Earliest &= tmp2; 
-        }
-    }
-
-    void buildLater(Function &F) {
-        // Forward flow
-        // LaterIn(j) = INTERSECT(Later(i, j)) for i in pred(j), j != n_0
-        // Later(i, j) = Earliest(i, j) + (LaterIn(i) & UEExpr(i))
-
-        std::queue<BasicBlock*> q;
-        std::map<BasicBlock*, bool> visited;
-        visited.clear();
-        for (auto &B : F) {
-            visited.insert(std::make_pair(&B, false));
-        }
-
-        BasicBlock* entryBlock = &(F.getEntryBlock());
-        q.push(entryBlock);
-        visited[entryBlock] = true;
-
-        // Init: LaterIn(n_0) = {}, LaterIn(n) = {all} for n != n_0
-        for (auto &B : F) {
-            BasicBlockInfo* bbinfo = &(blockmap[&B]);
-            bbinfo->LaterIn.reset();
-            bbinfo->LaterIn.flip();
-        }
-        blockmap[entryBlock].LaterIn.reset();
-
-        int changed = 0;
-        int n = exprmap.size();
-        // worklist: push in successors every time -> guarantee that each block will
-        // be traversed after each of predecessor at least once
-        while(!q.empty()) {
-            BasicBlock* p = q.front();
-            q.pop();
-            visited[p] = false;
-            changed = 0;
-
-            // Later(p, succ) = Earliest(p, succ) + (LaterIn(p) & UEExpr(p))
-            for(BasicBlock* succ : successors(p)) {
-                EdgeInfo* edgeinfo = &(edgemap[std::make_pair(p, succ)]);
-                BitVector old(edgeinfo->Later);
-
-                edgeinfo->Later.reset();
-                edgeinfo->Later |= blockmap[p].LaterIn;
-                edgeinfo->Later &= blockmap[p].UEExpr;
-                edgeinfo->Later |= edgeinfo->Earliest;
-                // edgeinfo->Later |= edgeinfo->Earliest;
-
-                // BitVector tmp(blockmap[p].LaterIn);
-                // tmp &= blockmap[p].UEExpr;
-                // edgeinfo->Later |= tmp;
-                
-                changed |= (old != edgeinfo->Later);
-            }
-
-            // LaterIn(j) = INTERSECT(Later(i, j)) for i in pred(j), j != n_0
-
-            for(BasicBlock *succ : successors(p)) {
-                BitVector old(blockmap[succ].LaterIn);
-                blockmap[succ].LaterIn &= edgemap[std::make_pair(p, succ)].Later;
-
-                if (changed | (old != blockmap[succ].LaterIn)) {
-                    if (!visited[succ]) {
-                        q.push(succ);
-                        visited[succ] = true;
-                    }
-                }
-            }
-        }
-    }
-
-    void buildInsertDelete(Function &F) {
-        // For each block / edge
-        // Insert(i, j) = Later(i, j) - LaterIn(j)
-
-        for (auto &edge : edges) {
-            EdgeInfo *edgeinfo = &(edgemap[edge]);
-            edgeinfo->Insert.reset();
-            edgeinfo->Insert |= edgeinfo->Later;
-
-            BitVector negLaterIn_j(blockmap[edgeinfo->end].LaterIn);
-            negLaterIn_j.flip();
-            edgeinfo->Insert &= negLaterIn_j;
-        }
-
-        // Delete(i) = UEExpr(i) - LaterIn(i), i != n_0
-        //             {}, i = n_0
-
-        for (auto &B : F) {
-            BasicBlockInfo *bbinfo = &(blockmap[&B]);
-            bbinfo->Delete.reset();
-            if (&B != &(F.getEntryBlock())) {
-                bbinfo->Delete |= bbinfo->UEExpr;
-                BitVector negLaterIn(bbinfo->LaterIn);
-                negLaterIn.flip();
-                bbinfo->Delete &= negLaterIn;
-            }
-        }
-
-    }
-
-    int codeMotion(Function &F) {
-        int n = exprmap.size();
-        
-        // Insert
-        int newBlockCnt = 0;
-        for (auto &edge : edges) {
-            EdgeInfo* edgeinfo = &(edgemap[edge]);
-            if (edgeinfo->Insert.empty())
-                continue;
-
-            IRBuilder<> *builder = nullptr;
-
-            for (int idx = 0; idx < n; idx++) {
-            
-                if (!edgeinfo->Insert[idx])
-                    continue;
-
-                BasicBlock* i = edgeinfo->start;
-                BasicBlock* j = edgeinfo->end;
-                Expression* expr = &(inv_exprmap[idx]);
-                Instruction* cloned_instr = expr->I->clone();
-
-                if (i->getSingleSuccessor()) {
-                    // node i has only one successor: insert at the end of i
-                    builder = new IRBuilder<>(i->getContext());
-                    builder->SetInsertPoint(i->getTerminator());
-                }
-                else if (j->getSinglePredecessor()) {
-                    // node j has only one predecessor: insert at the start of j
-                    builder = new IRBuilder<>(j->getContext());
-                    builder->SetInsertPoint(j->getFirstInsertionPt());
-                }
-                else {
-                    // split edge (i, j)
-                    // Don't put the new block into the function yet!!!
-                    // Ref.: https://stackoverflow.com/questions/61181446/how-to-build-a-empty-basicblock-and-insert-a-instruction-in-the-front
-                    LLVMContext &context = i->getContext();
-                    builder = new IRBuilder<>(i->getContext());
-                    edgeinfo->InsertBlock = BasicBlock::Create(i->getContext(), "newblock"+std::to_string(newBlockCnt++));
-                    builder->SetInsertPoint(edgeinfo->InsertBlock->getFirstInsertionPt());
-                }
-                
-                builder->Insert(cloned_instr);
-                
-                // Ref. Cornell course, LLVM for grad: addtomul example
-                // Everywhere the old instruction was used as an operand,
-                // use our new instruction instead.
-                for (auto& U : expr->I->uses()) {
-                        User* user = U.getUser(); // A User is anything with operands
-                        user->setOperand(U.getOperandNo(), cloned_instr);
-                }
-            }
-			delete builder;
-        }
-
-		for(auto &B : F) {
-			BasicBlockInfo* bbinfo = &(blockmap[&B]);
-			for(int idx=0; idx<n; idx++) {
-				if (!bbinfo->Delete[idx]) continue;
-				Instruction* I = inv_exprmap[idx].I;
-				// remove the expression
-				I->eraseFromParent();
-			}
-		}
-
-		// Put all newly created blocks into the function
-		// Ref.: https://stackoverflow.com/questions/61181446/how-to-build-a-empty-basicblock-and-insert-a-instruction-in-the-front
-		for(auto &edge : edges) {
-			EdgeInfo* edgeinfo = &(edgemap[edge]);
-			BasicBlock* i = edgeinfo->start;
-			BasicBlock* j = edgeinfo->end;
-
-			if (!(edgeinfo->InsertBlock))
-				continue;
-			// Set function parent and upstream node
-			BasicBlock* newBlock = edgeinfo->InsertBlock;
-			newBlock->insertInto(&F, i);
-
-			// Set descendant
-			Instruction *terminator = i->getTerminator();
-			int n = terminator->getNumSuccessors();
-			for(unsigned edge_num=0; edge_num<n; ++edge_num) {
-				if (terminator->getSuccessor(edge_num)==j) {
-					terminator->setSuccessor(edge_num, newBlock);
-					break;
-				}
-			}
-			// Add terminator instruction (BranchInst) into the end ot fhe new block
-			IRBuilder<> builder(newBlock);
-			builder.CreateBr(j);
-		}
-
-
-        return 1;
-    }
-
-    PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM) {
-        int changed = 0;
-        for (auto &F : M) {
-        	// errs() << F.getName() << " " << F.size() << "\n";
-        	// errs() << F << "\n";
-
-			if (F.isDeclaration()) // exclude external functions
-				continue;
-			if (F.empty()) {
-				// errs() << "No entry block found.\n";
-				continue;
-			}
-            
-            init(F);
-            buildNodes(F);
-            buildEdges(F);
-
-            for (auto &B : F) {
-                BasicBlockInfo* bbinfo = &(blockmap[&B]);
-                buildExprKill(bbinfo);
-                buildDEExpr(bbinfo);
-                buildUEExpr(bbinfo);
-            }
-            buildAvailExpr(F);
-            buildAnticiExpr(F);
-
-            buildEarliest(F);
-            buildLater(F);
-            buildInsertDelete(F);
-
-            /* Print out for debug*/
-            for (auto &B : F) {
-                printBasicBlockInfo(&blockmap[&B]);
-            }
-            for (auto &edge : edges) {
-                printEdgeInfo(&edgemap[edge]);
-            }
-
-            int this_changed = codeMotion(F);
-            changed |= this_changed;
-
-            // errs() << F << "\n";
-
-        }
-		
-		return PreservedAnalyses::all();
-    };
-};
-
-}
-
-extern "C" LLVM_ATTRIBUTE_WEAK ::llvm::PassPluginLibraryInfo
-llvmGetPassPluginInfo() {
-    return {
-        .APIVersion = LLVM_PLUGIN_API_VERSION,
-        .PluginName = "LCM pass",
-        .PluginVersion = "v0.1",
-        .RegisterPassBuilderCallbacks = [](PassBuilder &PB) {
-            PB.registerPipelineStartEPCallback(
-                [](ModulePassManager &MPM, OptimizationLevel Level) {
-                    MPM.addPass(LCMPass());
-                });
-        }
-    };
-}
+// This project is greatly aided by ChatGPT for LLVM syntax usage. 
+// You can see the process here at this link: 
+// https://chatgpt.com/share/67585d68-91e4-8003-b8bc-14576da175ad
+
+#include "llvm/Pass.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/PassPlugin.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+
+// Ref.: https://stackoverflow.com/questions/21708209/get-predecessors-for-basicblock-in-llvm
+// Get a BB's predecessors
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/ProfDataUtils.h" // branch weights, for the layout of split blocks
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/BitVector.h" // set operation
+#include "llvm/ADT/DenseMap.h" // mapping expression to bitvector position
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/Support/Allocator.h" // arena for the bit matrices
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Transforms/Utils/SSAUpdater.h" // one temporary per moved expression
+#include "llvm/Analysis/DomTreeUpdater.h" // split edges, for cached analyses
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ValueTracking.h" // what may trap, what may not return
+#include "llvm/IR/Dominators.h"
+#include <map> // DenseMap is hard to use...
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+#include "ExprTable.h"
+
+
+typedef std::pair<llvm::BasicBlock*, llvm::BasicBlock*> BBpair;
+
+using namespace llvm;
+using namespace lcm;
+
+static cl::opt<bool> DumpSets("lcm-dump-sets", cl::init(false), cl::Hidden,
+    cl::desc("Print the local and global sets of every block and edge"));
+
+static cl::opt<bool> PrintStats("lcm-stats", cl::Hidden,
+    cl::desc("Print per-function LCM statistics (universe size, solver visits)"));
+
+static cl::opt<unsigned> Threads("lcm-threads", cl::init(1),
+    cl::desc("Number of threads analyzing functions in parallel (0 = all cores)"));
+
+static cl::opt<unsigned> ParallelBlocks("lcm-parallel-blocks", cl::init(4096),
+    cl::desc("Split the per-block and per-edge work of functions with at least "
+             "this many blocks over the lcm-threads pool"));
+
+static cl::opt<unsigned> ParallelGrain("lcm-parallel-grain", cl::init(512),
+    cl::desc("Blocks or edges per task of the intra-function parallel loops"));
+
+enum class SolverKind { Worklist, SCC, Elimination };
+
+static cl::opt<SolverKind> Solver("lcm-solver", cl::init(SolverKind::Worklist),
+    cl::desc("Dataflow solver of the Avail, Antic and Later systems"),
+    cl::values(clEnumValN(SolverKind::Worklist, "worklist",
+                          "Iterate over the whole function to a fixpoint (default)"),
+               clEnumValN(SolverKind::SCC, "scc",
+                          "Sweep the SCCs of the CFG in topological order, iterating only inside loops"),
+               clEnumValN(SolverKind::Elimination, "elim",
+                          "Solve Avail and Antic by loop elimination, without iterating (worklist "
+                          "on irreducible CFGs and for Later)")));
+
+static cl::opt<bool> ConcurrentSolves("lcm-concurrent-solves", cl::init(true),
+    cl::desc("Run the availability and anticipation solves of functions split "
+             "over the pool (see lcm-parallel-blocks) concurrently"));
+
+static cl::opt<bool> PrintTimes("lcm-time",
+    cl::desc("Print the wall-clock time of each analysis phase per function"));
+
+static cl::opt<unsigned> ChunkExprs("lcm-chunk-exprs", cl::init(0),
+    cl::desc("Solve the expressions of a function in chunks of this many, to "
+             "bound the memory of the sets (0 = all at once; ignored with "
+             "-lcm-dump-sets)"));
+
+static cl::opt<bool> Lean("lcm-lean",
+    cl::desc("Compute Earliest inside the Later solve instead of storing it, "
+             "and store Insert only for edges that insert something (ignored "
+             "with -lcm-dump-sets)"));
+
+enum class FormulationKind { Edge, Node };
+
+static cl::opt<FormulationKind> Formulation("lcm-formulation", cl::init(FormulationKind::Edge),
+    cl::desc("Where the Earliest and Later equations are placed"),
+    cl::values(clEnumValN(FormulationKind::Edge, "edge",
+                          "On every CFG edge (default)"),
+               clEnumValN(FormulationKind::Node, "node",
+                          "At block entries and exits, and on the critical edges only "
+                          "(ignored with -lcm-dump-sets)")));
+
+#ifndef NDEBUG
+static cl::opt<bool> CrossCheck("lcm-cross-check",
+    cl::desc("Solve every function with both formulations and report where "
+             "Insert or Delete differ (ignored with -lcm-dump-sets)"));
+#endif
+
+static cl::opt<bool> LocalCSE("lcm-local-cse", cl::init(true),
+    cl::desc("Remove expressions recomputed in the same block before the "
+             "global analysis"));
+
+static cl::opt<unsigned> Rounds("lcm-rounds", cl::init(3),
+    cl::desc("Rounds of analysis and code motion per function, so that an "
+             "expression over a moved one can move in the next round"));
+
+static cl::opt<bool> FixedWidth("lcm-fixed-width", cl::init(true), cl::Hidden,
+    cl::desc("Specialize the set kernels for universes of up to 4 words"));
+
+namespace {
+
+// Never moved. Calls and allocas still define values, and calls may write
+// memory, so buildNodes scans them as expressions that are not candidates.
+bool ignore_instr(Instruction* I) {
+	return (isa<AllocaInst>(*I) || I->isTerminator() || isa<CallInst>(*I));
+	// terminator: branch, return
+}
+
+/* BitRow */
+// View of one row of a BitMatrix: n bits packed into 64-bit words. The bits
+// past n in the last word (and in any padding words) are kept zero, so rows
+// compare word by word.
+struct BitRow {
+    uint64_t* words;
+    unsigned n;
+
+    BitRow(uint64_t* words, unsigned n) : words(words), n(n) {}
+
+    unsigned size() const { return n; }
+    unsigned numWords() const { return (n + 63) / 64; }
+    uint64_t tailMask() const { return (n % 64) ? ~(~0ULL << (n % 64)) : ~0ULL; }
+
+    bool test(unsigned i) const { return (words[i / 64] >> (i % 64)) & 1; }
+    void set(unsigned i) { words[i / 64] |= 1ULL << (i % 64); }
+    void reset(unsigned i) { words[i / 64] &= ~(1ULL << (i % 64)); }
+
+    void set() {
+        unsigned w = numWords();
+        for (unsigned k = 0; k < w; k++)
+            words[k] = ~0ULL;
+        if (w)
+            words[w - 1] &= tailMask();
+    }
+    void reset() {
+        for (unsigned k = 0, w = numWords(); k < w; k++)
+            words[k] = 0;
+    }
+    void copy(BitRow x) {
+        for (unsigned k = 0, w = numWords(); k < w; k++)
+            words[k] = x.words[k];
+    }
+    // Index of the first set bit at or after i, or -1
+    int find_from(unsigned i) const {
+        unsigned w = numWords();
+        for (unsigned k = i / 64; k < w; k++) {
+            uint64_t word = words[k];
+            if (k == i / 64)
+                word &= ~0ULL << (i % 64);
+            if (word)
+                return k * 64 + __builtin_ctzll(word);
+        }
+        return -1;
+    }
+    int find_first() const { return find_from(0); }
+    int find_next(unsigned prev) const { return prev + 1 < n ? find_from(prev + 1) : -1; }
+
+    bool none() const {
+        for (unsigned k = 0, w = numWords(); k < w; k++)
+            if (words[k])
+                return false;
+        return true;
+    }
+
+    bool operator==(BitRow x) const {
+        for (unsigned k = 0, w = numWords(); k < w; k++)
+            if (words[k] != x.words[k])
+                return false;
+        return true;
+    }
+    bool operator!=(BitRow x) const { return !(*this == x); }
+};
+
+/* BitMatrix */
+// One dataflow property (e.g. AvailIn) for all blocks or all edges:
+// rows x n bits, row r at data + r * stride. Storage is owned by the arena.
+struct BitMatrix {
+    uint64_t* data = nullptr;
+    unsigned rows = 0;
+    unsigned n = 0;
+    unsigned stride = 0; // in words
+
+    BitRow operator[](unsigned r) const { return BitRow(data + (size_t)r * stride, n); }
+
+    // Bits [first, first + count) of every row, as a matrix; first % 64 == 0
+    BitMatrix columns(unsigned first, unsigned count) const {
+        return BitMatrix{data + first / 64, rows, count, stride};
+    }
+};
+
+/* SparseRowMatrix */
+// A BitMatrix most of whose rows are empty: a row is allocated from the
+// arena when it is first stored (alloc); the others all read as one shared
+// zero row.
+struct SparseRowMatrix {
+    SmallVector<uint64_t*, 64> data; // row -> words, nullptr if empty
+    uint64_t* zero = nullptr;
+    unsigned n = 0;
+    unsigned stride = 0; // in words
+    unsigned stored = 0;
+
+    void init(BumpPtrAllocator &arena, unsigned rows, unsigned n, unsigned stride) {
+        data.assign(rows, nullptr);
+        zero = newRow(arena, stride);
+        this->n = n;
+        this->stride = stride;
+        stored = 0;
+    }
+    static uint64_t* newRow(BumpPtrAllocator &arena, unsigned stride) {
+        uint64_t* row = static_cast<uint64_t*>(arena.Allocate(std::max(stride, 1u) * sizeof(uint64_t), Align(64)));
+        std::memset(row, 0, std::max(stride, 1u) * sizeof(uint64_t));
+        return row;
+    }
+    void alloc(BumpPtrAllocator &arena, unsigned r) {
+        if (!data[r]) {
+            data[r] = newRow(arena, stride);
+            stored++;
+        }
+    }
+
+    BitRow operator[](unsigned r) const { return BitRow(data[r] ? data[r] : zero, n); }
+    // Bits [first, first + count) of an allocated row r; first % 64 == 0
+    BitRow columns(unsigned r, unsigned first, unsigned count) const {
+        return BitRow(data[r] + first / 64, count);
+    }
+};
+
+/* Transfer kernels */
+// Each kernel evaluates one LCM equation over whole rows in a single pass,
+// without temporaries, and returns whether the destination row changed.
+// Every equation ANDs at least one plain row, so the bits past n stay zero.
+//
+// The word loop is written once for a generic word type W: uint64_t for the
+// scalar loop, and a GCC/Clang vector of 4 (AVX2) or 8 (AVX-512) words when
+// the plugin is compiled for such a target (e.g. -march=native).
+
+#if defined(__AVX512F__)
+#define LCM_VECTOR_WORDS 8
+#elif defined(__AVX2__)
+#define LCM_VECTOR_WORDS 4
+#endif
+
+#ifdef LCM_VECTOR_WORDS
+typedef uint64_t WordVec __attribute__((vector_size(LCM_VECTOR_WORDS * 8)));
+#endif
+
+template <typename W> W loadWords(const uint64_t* p) {
+    W w;
+    std::memcpy(&w, p, sizeof(W));
+    return w;
+}
+
+// Dst[k] = fn(k, W()) for every word k; fn loads its operands with
+// loadWords<W>(row.words + k). A nonzero Words fixes the number of words
+// at compile time (rows are padded to it, see FunctionLCM::fixedWords), so
+// the loop unrolls and small rows are evaluated in registers.
+template <unsigned Words = 0, typename Fn> bool evalRow(BitRow Dst, Fn fn) {
+    if constexpr (Words != 0) {
+        uint64_t diff = 0;
+        for (unsigned k = 0; k < Words; k++) {
+            uint64_t v = fn(k, uint64_t());
+            diff |= v ^ Dst.words[k];
+            Dst.words[k] = v;
+        }
+        return diff != 0;
+    }
+    unsigned w = Dst.numWords(), k = 0;
+    uint64_t diff = 0;
+#ifdef LCM_VECTOR_WORDS
+    WordVec vdiff = {};
+    for (; k + LCM_VECTOR_WORDS <= w; k += LCM_VECTOR_WORDS) {
+        WordVec v = fn(k, WordVec());
+        vdiff |= v ^ loadWords<WordVec>(Dst.words + k);
+        std::memcpy(Dst.words + k, &v, sizeof(v));
+    }
+    for (unsigned l = 0; l < LCM_VECTOR_WORDS; l++)
+        diff |= vdiff[l];
+#endif
+    for (; k < w; k++) {
+        uint64_t v = fn(k, uint64_t());
+        diff |= v ^ Dst.words[k];
+        Dst.words[k] = v;
+    }
+    return diff != 0;
+}
+
+// Out = Gen | (In & ~Kill)       (AvailOut, AntIn)
+template <unsigned Words = 0> bool transferGenKill(BitRow Out, BitRow Gen, BitRow In, BitRow Kill) {
+    return evalRow<Words>(Out, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return loadWords<W>(Gen.words + k) | (loadWords<W>(In.words + k) & ~loadWords<W>(Kill.words + k));
+    });
+}
+
+// Later = Earliest | (LaterIn & ~UEExpr)
+template <unsigned Words = 0> bool transferLater(BitRow Later, BitRow Earliest, BitRow LaterIn, BitRow UEExpr) {
+    return evalRow<Words>(Later, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return loadWords<W>(Earliest.words + k) | (loadWords<W>(LaterIn.words + k) & ~loadWords<W>(UEExpr.words + k));
+    });
+}
+
+// Dst &= Src                     (meet over predecessors / successors)
+template <unsigned Words = 0> bool meetIntersect(BitRow Dst, BitRow Src) {
+    return evalRow<Words>(Dst, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return loadWords<W>(Dst.words + k) & loadWords<W>(Src.words + k);
+    });
+}
+
+// Dst |= Src                     (meet of union problems)
+template <unsigned Words = 0> bool meetUnion(BitRow Dst, BitRow Src) {
+    return evalRow<Words>(Dst, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return loadWords<W>(Dst.words + k) | loadWords<W>(Src.words + k);
+    });
+}
+
+// Dst = A | B
+template <unsigned Words = 0> bool orRows(BitRow Dst, BitRow A, BitRow B) {
+    return evalRow<Words>(Dst, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return loadWords<W>(A.words + k) | loadWords<W>(B.words + k);
+    });
+}
+
+// Kernels of the elimination solver, on functions x -> G | (x & P) held as
+// row pairs (G, P).
+
+// Fa = Fa meet Fb: (Ga & Gb, (Ga & Pb) | (Pa & (Gb | Pb)))
+template <unsigned Words = 0> void meetFunction(BitRow Ga, BitRow Pa, BitRow Gb, BitRow Pb) {
+    evalRow<Words>(Pa, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return (loadWords<W>(Ga.words + k) & loadWords<W>(Pb.words + k))
+             | (loadWords<W>(Pa.words + k) & (loadWords<W>(Gb.words + k) | loadWords<W>(Pb.words + k)));
+    });
+    meetIntersect<Words>(Ga, Gb);
+}
+
+// F = F o E: (G | (Ge & P), P & Pe)
+template <unsigned Words = 0> void composeFunction(BitRow G, BitRow P, BitRow Ge, BitRow Pe) {
+    evalRow<Words>(G, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return loadWords<W>(G.words + k) | (loadWords<W>(Ge.words + k) & loadWords<W>(P.words + k));
+    });
+    meetIntersect<Words>(P, Pe);
+}
+
+// Earliest = (AntIn_j & ~AvailOut_i) & (Kill_i | ~AntOut_i)
+template <unsigned Words = 0> bool computeEarliest(BitRow Earliest, BitRow AntIn_j, BitRow AvailOut_i, BitRow Kill_i, BitRow AntOut_i) {
+    return evalRow<Words>(Earliest, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return (loadWords<W>(AntIn_j.words + k) & ~loadWords<W>(AvailOut_i.words + k))
+             & (loadWords<W>(Kill_i.words + k) | ~loadWords<W>(AntOut_i.words + k));
+    });
+}
+
+// Later = Earliest | (LaterIn & ~UEExpr), with Earliest computed in place (-lcm-lean)
+template <unsigned Words = 0>
+bool transferLaterEarliest(BitRow Later, BitRow AntIn_j, BitRow AvailOut_i, BitRow Kill_i, BitRow AntOut_i,
+                           BitRow LaterIn, BitRow UEExpr) {
+    return evalRow<Words>(Later, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return ((loadWords<W>(AntIn_j.words + k) & ~loadWords<W>(AvailOut_i.words + k))
+                & (loadWords<W>(Kill_i.words + k) | ~loadWords<W>(AntOut_i.words + k)))
+             | (loadWords<W>(LaterIn.words + k) & ~loadWords<W>(UEExpr.words + k));
+    });
+}
+
+// LaterIn |= Earliest, with Earliest computed in place (-lcm-formulation=node)
+template <unsigned Words = 0>
+bool orEarliest(BitRow LaterIn, BitRow AntIn_j, BitRow AvailOut_i, BitRow Kill_i, BitRow AntOut_i) {
+    return evalRow<Words>(LaterIn, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return loadWords<W>(LaterIn.words + k)
+             | ((loadWords<W>(AntIn_j.words + k) & ~loadWords<W>(AvailOut_i.words + k))
+                & (loadWords<W>(Kill_i.words + k) | ~loadWords<W>(AntOut_i.words + k)));
+    });
+}
+
+// A & ~B != {}
+template <unsigned Words = 0> bool anyAndNot(BitRow A, BitRow B) {
+    uint64_t any = 0;
+    for (unsigned k = 0, w = Words ? Words : A.numWords(); k < w; k++)
+        any |= A.words[k] & ~B.words[k];
+    return any != 0;
+}
+
+// Dst = A & ~B                   (Insert = Later & ~LaterIn, Delete = UE & ~LaterIn,
+//                                 LaterOut = LaterIn & ~UE)
+template <unsigned Words = 0> bool andNot(BitRow Dst, BitRow A, BitRow B) {
+    return evalRow<Words>(Dst, [&](unsigned k, auto w) {
+        using W = decltype(w);
+        return loadWords<W>(A.words + k) & ~loadWords<W>(B.words + k);
+    });
+}
+
+/* CompactRows */
+// Read-only copy of a mostly empty matrix, for consumers that walk the set
+// bits of a row. Each row is stored as its sorted bit indices, or as its
+// words once it has 2 or more set bits per word (then the words are the
+// smaller form). Row r's indices are idx[idxBegin[r] .. idxBegin[r+1]), its
+// words words[wordBegin[r] .. wordBegin[r+1]); one of the two is empty.
+struct CompactRows {
+    SmallVector<unsigned, 65> idxBegin;
+    SmallVector<unsigned, 64> idx;
+    SmallVector<unsigned, 65> wordBegin;
+    SmallVector<uint64_t, 64> words;
+    unsigned denseRows = 0;
+
+    // row(r) is the BitRow of row r
+    template <typename Row> void build(unsigned rows, Row row) {
+        idxBegin.assign(rows + 1, 0);
+        wordBegin.assign(rows + 1, 0);
+        idx.clear();
+        words.clear();
+        denseRows = 0;
+        for (unsigned r = 0; r < rows; r++) {
+            idxBegin[r] = idx.size();
+            wordBegin[r] = words.size();
+            BitRow x = row(r);
+            unsigned w = x.numWords(), count = 0;
+            for (unsigned k = 0; k < w; k++)
+                count += __builtin_popcountll(x.words[k]);
+            if (count >= 2 * w && count) {
+                words.append(x.words, x.words + w);
+                denseRows++;
+            } else {
+                for (int i = x.find_first(); i != -1; i = x.find_next(i))
+                    idx.push_back(i);
+            }
+        }
+        idxBegin[rows] = idx.size();
+        wordBegin[rows] = words.size();
+    }
+
+    bool empty(unsigned r) const {
+        return idxBegin[r] == idxBegin[r + 1] && wordBegin[r] == wordBegin[r + 1];
+    }
+    // Whether row r has the same bits as row r of x
+    bool sameRow(const CompactRows &x, unsigned r) const {
+        SmallVector<unsigned, 16> a, b;
+        forEach(r, [&](unsigned i) { a.push_back(i); });
+        x.forEach(r, [&](unsigned i) { b.push_back(i); });
+        return a == b;
+    }
+    // fn(i) for every set bit i of row r, in increasing order
+    template <typename Fn> void forEach(unsigned r, Fn fn) const {
+        for (unsigned k = idxBegin[r]; k < idxBegin[r + 1]; k++)
+            fn(idx[k]);
+        for (unsigned k = wordBegin[r]; k < wordBegin[r + 1]; k++)
+            for (uint64_t word = words[k]; word; word &= word - 1)
+                fn((k - wordBegin[r]) * 64 + __builtin_ctzll(word));
+    }
+    size_t bytes() const {
+        return (idxBegin.size() + idx.size() + wordBegin.size()) * sizeof(unsigned) + words.size() * sizeof(uint64_t);
+    }
+};
+
+/* BasicBlockInfo */
+struct BasicBlockInfo {
+	BasicBlock* B;
+
+	bool operator==(const BasicBlockInfo &x) const {
+		return (B == x.B);
+	}
+	bool operator<(const BasicBlockInfo &x) const {
+		return (B < x.B);
+	}
+
+};
+
+// Per-block sets, one BitMatrix per property (row = # of block)
+struct BlockSets {
+	BitMatrix Exprs;
+	BitMatrix DEExpr;
+	BitMatrix UEExpr;
+	BitMatrix ExprKill;
+	BitMatrix AvailOut;
+	BitMatrix AvailIn;
+	BitMatrix AntOut;
+	BitMatrix AntIn;
+
+	BitMatrix LaterIn;
+	BitMatrix Delete;
+
+	// Node formulation only: Later(b, s) for a b with one successor s, else
+	// LaterIn & ~UEExpr (Earliest is added at the single-predecessor succs)
+	BitMatrix LaterOut;
+
+	// AntOut(i) as Earliest(i, j) reads it. Nothing lies above the entry to
+	// insert on, so Earliest(n_0, j) = AntIn(j) - AvailOut(n_0), which
+	// AvailIn(n_0) = {} in place of AntOut(n_0) gives.
+	BitRow earliestAntOut(unsigned i, unsigned entry) const {
+		return i == entry ? AvailIn[i] : AntOut[i];
+	}
+};
+
+/* EdgeInfo */
+struct EdgeInfo {
+	BBpair edge;
+	BasicBlock* start;
+	BasicBlock* end;
+
+	BasicBlock* InsertBlock;
+
+	bool operator==(const EdgeInfo &x) const { return (edge == x.edge); }
+	bool operator<(const EdgeInfo &x) const { return (edge < x.edge); }
+};
+
+// Per-edge sets, one BitMatrix per property (row = # of edge). In the node
+// formulation, Later is the only one, with a row per critical edge.
+struct EdgeSets {
+	BitMatrix Earliest;
+	BitMatrix Later;
+	BitMatrix Insert;
+};
+
+void initEdgeInfo(EdgeInfo* edgeinfo, BBpair pair) {
+	edgeinfo->edge = pair;
+	edgeinfo->start = pair.first; edgeinfo->end = pair.second;
+	edgeinfo->InsertBlock = NULL;
+}
+
+// Carve all block and edge matrices of a function out of one zeroed,
+// cache-line-aligned allocation from the arena. Every matrix starts on its
+// own cache line. Rows of n bits take stride >= (n + 63) / 64 words.
+// Returns the allocation, which starts at bsets.Exprs.data.
+// With lean, only Later of the edge matrices is allocated. With node,
+// LaterOut is allocated too (nedges is then the number of critical edges).
+MutableArrayRef<uint64_t> initBitMatrices(BumpPtrAllocator &arena, BlockSets &bsets, unsigned nblocks,
+                                          EdgeSets &esets, unsigned nedges, unsigned n, unsigned stride,
+                                          bool lean, bool node) {
+	SmallVector<BitMatrix*, 11> blockmats = {
+		&bsets.Exprs, &bsets.DEExpr, &bsets.UEExpr, &bsets.ExprKill,
+		&bsets.AvailOut, &bsets.AvailIn, &bsets.AntOut, &bsets.AntIn,
+		&bsets.LaterIn, &bsets.Delete,
+	};
+	if (node)
+		blockmats.push_back(&bsets.LaterOut);
+	else
+		bsets.LaterOut = BitMatrix();
+	SmallVector<BitMatrix*, 3> edgemats = { &esets.Later };
+	if (lean)
+		esets.Earliest = esets.Insert = BitMatrix();
+	else
+		edgemats.append({ &esets.Earliest, &esets.Insert });
+
+	auto lineWords = [](size_t words) { return (words + 7) & ~(size_t)7; };
+	size_t blockWords = lineWords((size_t)nblocks * stride);
+	size_t edgeWords = lineWords((size_t)nedges * stride);
+	size_t total = std::size(blockmats) * blockWords + std::size(edgemats) * edgeWords;
+
+	uint64_t* data = static_cast<uint64_t*>(arena.Allocate(std::max<size_t>(total, 1) * sizeof(uint64_t), Align(64)));
+	std::memset(data, 0, total * sizeof(uint64_t));
+	MutableArrayRef<uint64_t> all(data, total);
+	for (BitMatrix* m : blockmats) {
+		*m = BitMatrix{data, nblocks, n, stride};
+		data += blockWords;
+	}
+	for (BitMatrix* m : edgemats) {
+		*m = BitMatrix{data, nedges, n, stride};
+		data += edgeWords;
+	}
+	return all;
+}
+
+// One zeroed, cache-line-aligned matrix from the arena
+BitMatrix newBitMatrix(BumpPtrAllocator &arena, unsigned rows, unsigned n, unsigned stride) {
+	size_t total = std::max<size_t>((size_t)rows * stride, 1);
+	uint64_t* data = static_cast<uint64_t*>(arena.Allocate(total * sizeof(uint64_t), Align(64)));
+	std::memset(data, 0, total * sizeof(uint64_t));
+	return BitMatrix{data, rows, n, stride};
+}
+
+/* CFGIndex */
+// Per-function numbering of blocks in reverse post-order (blocks unreachable
+// from the entry follow in function order), and the CFG edges in CSR form:
+// edges are numbered grouped by source block, so the out-edges of block b
+// are [succBegin[b], succBegin[b+1]); the in-edges are
+// predEdges[predBegin[b] .. predBegin[b+1]). reachesExit[b] = 1 if a path
+// leads from b to a block without successors.
+struct CFGIndex {
+    SmallVector<BasicBlock*, 32> blocks; // # of block -> block
+    DenseMap<BasicBlock*, unsigned> blockidx; // block -> # of block
+
+    SmallVector<unsigned, 64> edgeSrc; // # of edge -> # of source block
+    SmallVector<unsigned, 64> edgeDst; // # of edge -> # of target block
+    SmallVector<unsigned, 33> succBegin;
+    SmallVector<unsigned, 33> predBegin;
+    SmallVector<unsigned, 64> predEdges;
+    SmallVector<uint8_t, 32> reachesExit;
+
+    void build(Function &F) {
+        blocks.clear();
+        blockidx.clear();
+        for (BasicBlock* B : ReversePostOrderTraversal<Function*>(&F)) {
+            blockidx[B] = blocks.size();
+            blocks.push_back(B);
+        }
+        for (auto &B : F) {
+            if (blockidx.insert(std::make_pair(&B, blocks.size())).second)
+                blocks.push_back(&B);
+        }
+
+        // Out-edges; a successor listed twice (e.g. by a switch) is one edge.
+        // lastSrc[s] is the last block with an edge to s, so a duplicate is
+        // found in O(1) whatever the fan-out of the switch.
+        unsigned nblocks = blocks.size();
+        edgeSrc.clear();
+        edgeDst.clear();
+        succBegin.assign(nblocks + 1, 0);
+        SmallVector<unsigned, 33> npreds(nblocks, 0);
+        SmallVector<unsigned, 33> lastSrc(nblocks, ~0u);
+        for (unsigned b = 0; b < nblocks; b++) {
+            succBegin[b] = edgeSrc.size();
+            for (BasicBlock* succ : successors(blocks[b])) {
+                unsigned s = blockidx[succ];
+                if (lastSrc[s] == b)
+                    continue;
+                lastSrc[s] = b;
+                edgeSrc.push_back(b);
+                edgeDst.push_back(s);
+                npreds[s]++;
+            }
+        }
+        succBegin[nblocks] = edgeSrc.size();
+
+        // In-edges: counting sort of the edges by target block
+        predBegin.assign(nblocks + 1, 0);
+        for (unsigned b = 0; b < nblocks; b++)
+            predBegin[b + 1] = predBegin[b] + npreds[b];
+        predEdges.assign(edgeSrc.size(), 0);
+        SmallVector<unsigned, 33> fill(predBegin.begin(), predBegin.end() - 1);
+        for (unsigned e = 0; e < edgeSrc.size(); e++)
+            predEdges[fill[edgeDst[e]]++] = e;
+
+        // Exits, then everything that reaches them against the edges
+        reachesExit.assign(nblocks, 0);
+        SmallVector<unsigned, 32> work;
+        for (unsigned b = 0; b < nblocks; b++) {
+            if (numSuccs(b) == 0) {
+                reachesExit[b] = 1;
+                work.push_back(b);
+            }
+        }
+        while (!work.empty()) {
+            unsigned b = work.pop_back_val();
+            for (unsigned e : predEdgesOf(b)) {
+                if (!reachesExit[edgeSrc[e]]) {
+                    reachesExit[edgeSrc[e]] = 1;
+                    work.push_back(edgeSrc[e]);
+                }
+            }
+        }
+    }
+
+    // inCycle[b] = 1 for every block on a cycle, and for some blocks between
+    // cycles. Any cycle through b takes an edge u -> v with v <= b <= u
+    // (the edge back into b, or the first one that drops below b), so b is
+    // marked if it lies in the span of such an edge.
+    void markCycles(SmallVectorImpl<uint8_t> &inCycle) const {
+        unsigned nblocks = numBlocks();
+        SmallVector<int, 33> open(nblocks + 1, 0);
+        for (unsigned e = 0; e < numEdges(); e++) {
+            if (edgeSrc[e] >= edgeDst[e]) {
+                open[edgeDst[e]]++;
+                open[edgeSrc[e] + 1]--;
+            }
+        }
+        inCycle.assign(nblocks, 0);
+        int depth = 0;
+        for (unsigned b = 0; b < nblocks; b++) {
+            depth += open[b];
+            inCycle[b] = depth > 0;
+        }
+    }
+
+    unsigned numBlocks() const { return blocks.size(); }
+    unsigned numEdges() const { return edgeSrc.size(); }
+    unsigned indexOf(BasicBlock* B) const { return blockidx.lookup(B); }
+
+    unsigned numSuccs(unsigned b) const { return succBegin[b + 1] - succBegin[b]; }
+    unsigned numPreds(unsigned b) const { return predBegin[b + 1] - predBegin[b]; }
+    // From a block with several successors to one with several predecessors
+    bool isCritical(unsigned e) const { return numSuccs(edgeSrc[e]) > 1 && numPreds(edgeDst[e]) > 1; }
+
+    auto succEdges(unsigned b) const { return seq(succBegin[b], succBegin[b + 1]); }
+    ArrayRef<unsigned> predEdgesOf(unsigned b) const {
+        return ArrayRef<unsigned>(predEdges).slice(predBegin[b], predBegin[b + 1] - predBegin[b]);
+    }
+};
+
+/* ValueIndex */
+// Dense numbering of the values the instructions of a function define, with
+// CSR tables: expression -> numbers of its operands that are defined in the
+// function, and value -> expressions that use it. Only the candidate
+// expressions (IDs below ncands) get operand and user entries. Memory is one
+// more value: every instruction that may write to memory defines it, and
+// every candidate that reads memory uses it. So is the barrier: every
+// instruction that may not go on to the next one (a call that may not
+// return) defines it, and every candidate that may trap uses it, so that
+// none is anticipated above such an instruction and hoisted onto a path
+// that never reached it.
+struct ValueIndex {
+    DenseMap<Value*, unsigned> valnum;
+    unsigned memory; // the number of memory, past the numbers in valnum
+    unsigned barrier; // memory + 1
+    SmallVector<unsigned, 128> instDest; // # of instruction (in instrs) -> # of its value
+    SmallVector<uint8_t, 128> instClobbers; // # of instruction -> it may write to memory
+    SmallVector<uint8_t, 128> instBarrier; // # of instruction -> it may not go on to the next
+    SmallVector<unsigned, 65> opBegin;
+    SmallVector<unsigned, 128> opVals;
+    SmallVector<unsigned, 65> userBegin;
+    SmallVector<unsigned, 128> userExprs;
+
+    void build(const ExprTable &exprtable, unsigned ncands, ArrayRef<Instruction*> instrs) {
+        valnum.clear();
+        instDest.resize(instrs.size());
+        instClobbers.resize(instrs.size());
+        instBarrier.resize(instrs.size());
+        for (unsigned k = 0; k < instrs.size(); k++) {
+            instDest[k] = valnum.insert(std::make_pair(instrs[k], valnum.size())).first->second;
+            instClobbers[k] = instrs[k]->mayWriteToMemory();
+            instBarrier[k] = !isGuaranteedToTransferExecutionToSuccessor(instrs[k]);
+        }
+        memory = valnum.size();
+        barrier = memory + 1;
+        unsigned n = ncands;
+
+        // An operand appearing twice in one expression is listed once
+        opBegin.assign(n + 1, 0);
+        opVals.clear();
+        SmallVector<unsigned, 65> nusers(numValues(), 0);
+        for (unsigned id = 0; id < n; id++) {
+            opBegin[id] = opVals.size();
+            for (Value* op : exprtable[id].operands) {
+                auto it = valnum.find(op);
+                if (it == valnum.end() || is_contained(operandsOf(id, opVals.size()), it->second))
+                    continue;
+                opVals.push_back(it->second);
+                nusers[it->second]++;
+            }
+            if (exprtable[id].I->mayReadFromMemory()) {
+                opVals.push_back(memory);
+                nusers[memory]++;
+            }
+            if (!isSafeToSpeculativelyExecute(exprtable[id].I)) {
+                opVals.push_back(barrier);
+                nusers[barrier]++;
+            }
+        }
+        opBegin[n] = opVals.size();
+
+        // Users: counting sort of the (expression, operand) pairs by operand
+        userBegin.assign(numValues() + 1, 0);
+        for (unsigned v = 0; v < numValues(); v++)
+            userBegin[v + 1] = userBegin[v] + nusers[v];
+        userExprs.assign(opVals.size(), 0);
+        SmallVector<unsigned, 65> fill(userBegin.begin(), userBegin.end() - 1);
+        for (unsigned id = 0; id < n; id++)
+            for (unsigned v : operandsOf(id))
+                userExprs[fill[v]++] = id;
+    }
+
+    unsigned numValues() const { return valnum.size() + 2; }
+    ArrayRef<unsigned> operandsOf(unsigned id) const { return operandsOf(id, opBegin[id + 1]); }
+    ArrayRef<unsigned> operandsOf(unsigned id, unsigned end) const {
+        return ArrayRef<unsigned>(opVals).slice(opBegin[id], end - opBegin[id]);
+    }
+    ArrayRef<unsigned> usersOf(unsigned v) const {
+        return ArrayRef<unsigned>(userExprs).slice(userBegin[v], userBegin[v + 1] - userBegin[v]);
+    }
+};
+
+/* Worklist */
+// Blocks waiting to be visited, as a bitset over block numbers. Since blocks
+// are numbered in RPO, a forward solve pops the lowest number and a backward
+// solve the highest (= lowest post-order number).
+struct Worklist {
+    BitVector pending;
+    BitVector visited; // popped at least once
+
+    void init(unsigned nblocks) {
+        pending.reset();
+        pending.resize(nblocks);
+        visited.reset();
+        visited.resize(nblocks);
+    }
+    void push(unsigned b) { pending.set(b); }
+    bool isVisited(unsigned b) const { return visited.test(b); }
+    int popFirst() {
+        int b = pending.find_first();
+        if (b >= 0) {
+            pending.reset(b);
+            visited.set(b);
+        }
+        return b;
+    }
+    int popLast() {
+        int b = pending.find_last();
+        if (b >= 0) {
+            pending.reset(b);
+            visited.set(b);
+        }
+        return b;
+    }
+};
+
+/* FlowGraph */
+// The CFG as a solve sees it: along the flow, the successors of a block are
+// its CFG successors for a forward solve and its CFG predecessors for a
+// backward one.
+struct FlowGraph {
+    const CFGIndex &cfg;
+    bool forward;
+
+    unsigned numSuccs(unsigned b) const {
+        return forward ? cfg.succBegin[b + 1] - cfg.succBegin[b] : cfg.predBegin[b + 1] - cfg.predBegin[b];
+    }
+    unsigned numPreds(unsigned b) const {
+        return forward ? cfg.predBegin[b + 1] - cfg.predBegin[b] : cfg.succBegin[b + 1] - cfg.succBegin[b];
+    }
+    unsigned succ(unsigned b, unsigned k) const {
+        return forward ? cfg.edgeDst[cfg.succBegin[b] + k] : cfg.edgeSrc[cfg.predEdges[cfg.predBegin[b] + k]];
+    }
+    unsigned pred(unsigned b, unsigned k) const {
+        return forward ? cfg.edgeSrc[cfg.predEdges[cfg.predBegin[b] + k]] : cfg.edgeDst[cfg.succBegin[b] + k];
+    }
+};
+
+/* SCCOrder */
+// Strongly connected components of the blocks, in topological order of the
+// condensation. The search starts at the roots of the solve, then at any
+// block they do not reach along the flow (backward: a block that never
+// reaches an exit), so every block is covered.
+// Components are grouped into levels: one only depends on components of
+// earlier levels, so the components of a level can be solved in any order.
+// Members of a component are listed in flow order (RPO forward, the reverse
+// backward).
+struct SCCOrder {
+    static constexpr unsigned NONE = ~0u;
+
+    SmallVector<unsigned, 32> sccOf;     // # of block -> # of its SCC, NONE if not covered
+    SmallVector<unsigned, 32> members;   // covered blocks, SCC by SCC
+    SmallVector<unsigned, 33> sccBegin;  // # of SCC -> its first member
+    SmallVector<bool, 32> cyclic;        // # of SCC -> contains a cycle
+    SmallVector<unsigned, 9> levelBegin; // # of level -> its first SCC
+
+    unsigned numSCCs() const { return cyclic.size(); }
+    unsigned numLevels() const { return levelBegin.size() - 1; }
+    bool covers(unsigned b) const { return sccOf[b] != NONE; }
+    ArrayRef<unsigned> membersOf(unsigned c) const {
+        return ArrayRef<unsigned>(members).slice(sccBegin[c], sccBegin[c + 1] - sccBegin[c]);
+    }
+
+    void build(const CFGIndex &cfg, bool forward, ArrayRef<unsigned> roots) {
+        unsigned nblocks = cfg.numBlocks();
+        FlowGraph flow{cfg, forward};
+
+        // Tarjan, iteratively; emits the SCCs in reverse topological order
+        SmallVector<unsigned, 32> index(nblocks, NONE), low(nblocks), stack, order;
+        SmallVector<unsigned, 33> begins;
+        SmallVector<std::pair<unsigned, unsigned>, 32> dfs; // (block, # of next neighbor)
+        unsigned counter = 0;
+        sccOf.assign(nblocks, NONE);
+        auto discover = [&](unsigned b) {
+            index[b] = low[b] = counter++;
+            stack.push_back(b);
+            dfs.push_back(std::make_pair(b, 0u));
+        };
+        SmallVector<unsigned, 32> starts(roots.begin(), roots.end());
+        append_range(starts, seq(0u, nblocks));
+        for (unsigned root : starts) {
+            if (index[root] != NONE)
+                continue;
+            discover(root);
+            while (!dfs.empty()) {
+                unsigned b = dfs.back().first;
+                unsigned k = dfs.back().second;
+                if (k < flow.numSuccs(b)) {
+                    dfs.back().second++;
+                    unsigned s = flow.succ(b, k);
+                    if (index[s] == NONE)
+                        discover(s);
+                    else if (sccOf[s] == NONE) // still on the stack
+                        low[b] = std::min(low[b], index[s]);
+                    continue;
+                }
+                dfs.pop_back();
+                if (!dfs.empty())
+                    low[dfs.back().first] = std::min(low[dfs.back().first], low[b]);
+                if (low[b] == index[b]) {
+                    unsigned c = begins.size(), w;
+                    begins.push_back(order.size());
+                    do {
+                        w = stack.pop_back_val();
+                        sccOf[w] = c;
+                        order.push_back(w);
+                    } while (w != b);
+                }
+            }
+        }
+        unsigned nsccs = begins.size();
+        begins.push_back(order.size());
+
+        // Level of each SCC (in topological order, i.e. from the last one
+        // emitted): one more than the deepest SCC flowing into it
+        SmallVector<unsigned, 32> level(nsccs, 0);
+        SmallVector<bool, 32> loops(nsccs, false);
+        unsigned nlevels = 0;
+        for (unsigned c = nsccs; c-- > 0; ) {
+            loops[c] = begins[c + 1] - begins[c] > 1;
+            for (unsigned w : ArrayRef<unsigned>(order).slice(begins[c], begins[c + 1] - begins[c])) {
+                for (unsigned k = 0; k < flow.numPreds(w); k++) {
+                    unsigned p = sccOf[flow.pred(w, k)];
+                    if (p == c)
+                        loops[c] = true;
+                    else if (p != NONE)
+                        level[c] = std::max(level[c], level[p] + 1);
+                }
+            }
+            nlevels = std::max(nlevels, level[c] + 1);
+        }
+
+        // Counting sort of the SCCs by level, topological order within a level
+        levelBegin.assign(nlevels + 1, 0);
+        for (unsigned c = 0; c < nsccs; c++)
+            levelBegin[level[c] + 1]++;
+        for (unsigned l = 0; l < nlevels; l++)
+            levelBegin[l + 1] += levelBegin[l];
+        SmallVector<unsigned, 32> renum(nsccs);
+        SmallVector<unsigned, 9> fill(levelBegin.begin(), levelBegin.end() - 1);
+        for (unsigned c = nsccs; c-- > 0; )
+            renum[c] = fill[level[c]]++;
+
+        SmallVector<unsigned, 32> sccs(nsccs);
+        for (unsigned c = 0; c < nsccs; c++)
+            sccs[renum[c]] = c;
+        members.clear();
+        sccBegin.clear();
+        cyclic.clear();
+        for (unsigned c : sccs) {
+            sccBegin.push_back(members.size());
+            cyclic.push_back(loops[c]);
+            unsigned first = members.size();
+            members.append(order.begin() + begins[c], order.begin() + begins[c + 1]);
+            if (forward)
+                llvm::sort(members.begin() + first, members.end());
+            else
+                llvm::sort(members.begin() + first, members.end(), std::greater<unsigned>());
+        }
+        sccBegin.push_back(members.size());
+        for (unsigned &c : sccOf)
+            if (c != NONE)
+                c = renum[c];
+    }
+};
+
+/* LoopNest */
+// Loop nesting forest of the blocks, by Havlak's algorithm over a DFS along
+// the flow from the roots of the solve, then from any block they do not
+// reach (those start at the top of the meet, the roots at {}).
+// loopOf[b] is the header of the innermost loop around b (for a header: the
+// loop around its own loop), NONE at top level. If a loop has a second entry
+// the flow graph is irreducible: reducible is false and the nest is partial.
+struct LoopNest {
+    static constexpr unsigned NONE = ~0u;
+
+    bool reducible = true;
+    SmallVector<unsigned, 32> pre;      // # of block -> DFS preorder #, NONE if not covered
+    SmallVector<unsigned, 32> last;     // # of block -> last preorder # in its DFS subtree
+    SmallVector<bool, 32> isRoot;
+    SmallVector<unsigned, 33> predBegin; // # of block -> its covered preds along the flow
+    SmallVector<unsigned, 64> preds;
+    SmallVector<unsigned, 32> loopOf;
+    SmallVector<bool, 32> isHeader;
+    SmallVector<unsigned, 33> bodyBegin; // # of header -> blocks directly in its loop, in RPO
+    SmallVector<unsigned, 32> body;
+    SmallVector<unsigned, 32> top;       // blocks in no loop, in RPO
+    SmallVector<unsigned, 8> headers;    // innermost loops first
+
+    bool covers(unsigned b) const { return pre[b] != NONE; }
+    // a is b or a DFS ancestor of b; for a pred b of a, b -> a is a back edge
+    bool isAncestor(unsigned a, unsigned b) const { return pre[a] <= pre[b] && pre[b] <= last[a]; }
+    ArrayRef<unsigned> predsOf(unsigned b) const {
+        return ArrayRef<unsigned>(preds).slice(predBegin[b], predBegin[b + 1] - predBegin[b]);
+    }
+    ArrayRef<unsigned> bodyOf(unsigned h) const {
+        return ArrayRef<unsigned>(body).slice(bodyBegin[h], bodyBegin[h + 1] - bodyBegin[h]);
+    }
+
+    void build(const CFGIndex &cfg, bool forward, ArrayRef<unsigned> roots) {
+        unsigned nblocks = cfg.numBlocks();
+        FlowGraph flow{cfg, forward};
+        reducible = true;
+
+        // DFS along the flow
+        pre.assign(nblocks, NONE);
+        last.assign(nblocks, NONE);
+        isRoot.assign(nblocks, false);
+        SmallVector<unsigned, 32> post, byPre;
+        SmallVector<std::pair<unsigned, unsigned>, 32> dfs; // (block, # of next succ)
+        for (unsigned root : roots)
+            isRoot[root] = true;
+        SmallVector<unsigned, 32> starts(roots.begin(), roots.end());
+        append_range(starts, seq(0u, nblocks));
+        for (unsigned root : starts) {
+            if (pre[root] != NONE)
+                continue;
+            pre[root] = byPre.size();
+            byPre.push_back(root);
+            dfs.push_back(std::make_pair(root, 0u));
+            while (!dfs.empty()) {
+                unsigned b = dfs.back().first;
+                unsigned k = dfs.back().second;
+                if (k < flow.numSuccs(b)) {
+                    dfs.back().second++;
+                    unsigned s = flow.succ(b, k);
+                    if (pre[s] == NONE) {
+                        pre[s] = byPre.size();
+                        byPre.push_back(s);
+                        dfs.push_back(std::make_pair(s, 0u));
+                    }
+                    continue;
+                }
+                last[b] = byPre.size() - 1;
+                post.push_back(b);
+                dfs.pop_back();
+            }
+        }
+
+        predBegin.assign(nblocks + 1, 0);
+        preds.clear();
+        for (unsigned b = 0; b < nblocks; b++) {
+            predBegin[b] = preds.size();
+            if (!covers(b))
+                continue;
+            for (unsigned k = 0; k < flow.numPreds(b); k++) {
+                if (covers(flow.pred(b, k)))
+                    preds.push_back(flow.pred(b, k));
+            }
+        }
+        predBegin[nblocks] = preds.size();
+
+        // Havlak: collapse loops innermost first (decreasing preorder). The
+        // body of w's loop is what reaches a back edge into w without passing
+        // w; in a reducible graph all of it lies in w's DFS subtree.
+        loopOf.assign(nblocks, NONE);
+        isHeader.assign(nblocks, false);
+        headers.clear();
+        SmallVector<unsigned, 32> rep(nblocks), mark(nblocks, NONE);
+        for (unsigned b = 0; b < nblocks; b++)
+            rep[b] = b;
+        auto find = [&](unsigned b) {
+            while (rep[b] != b)
+                b = rep[b] = rep[rep[b]];
+            return b;
+        };
+        SmallVector<unsigned, 16> loop, work;
+        for (unsigned i = byPre.size(); i-- > 0; ) {
+            unsigned w = byPre[i];
+            loop.clear();
+            for (unsigned p : predsOf(w)) {
+                if (!isAncestor(w, p))
+                    continue;
+                isHeader[w] = true;
+                unsigned x = find(p);
+                if (x != w && mark[x] != w) {
+                    mark[x] = w;
+                    loop.push_back(x);
+                }
+            }
+            work.assign(loop.begin(), loop.end());
+            while (!work.empty()) {
+                unsigned x = work.pop_back_val();
+                for (unsigned y : predsOf(x)) {
+                    if (isAncestor(x, y)) // a latch of x's own loop
+                        continue;
+                    y = find(y);
+                    if (!isAncestor(w, y)) {
+                        reducible = false;
+                        return;
+                    }
+                    if (y != w && mark[y] != w) {
+                        mark[y] = w;
+                        loop.push_back(y);
+                        work.push_back(y);
+                    }
+                }
+            }
+            if (isHeader[w])
+                headers.push_back(w);
+            for (unsigned x : loop) {
+                loopOf[x] = w;
+                rep[x] = w;
+            }
+        }
+
+        // Loop bodies and the top level, in RPO
+        bodyBegin.assign(nblocks + 1, 0);
+        for (unsigned b : post) {
+            if (loopOf[b] != NONE)
+                bodyBegin[loopOf[b] + 1]++;
+        }
+        for (unsigned b = 0; b < nblocks; b++)
+            bodyBegin[b + 1] += bodyBegin[b];
+        body.assign(bodyBegin[nblocks], 0);
+        top.clear();
+        SmallVector<unsigned, 33> fill(bodyBegin.begin(), bodyBegin.end() - 1);
+        for (unsigned b : reverse(post)) {
+            if (loopOf[b] != NONE)
+                body[fill[loopOf[b]]++] = b;
+            else
+                top.push_back(b);
+        }
+    }
+};
+
+/* Dataflow problems */
+// Instances of the problem interface of FunctionLCM::solve.
+
+// Out = Gen | (In & ~Kill), meet over the preds along the flow, In = {} at
+// the entry (forward) or, backward, at the blocks without successors and at
+// those that reach none: nothing is anticipated past a loop that never
+// exits, so no expression is speculated into a path that enters it.
+template <bool IsForward, bool IsIntersect> struct GenKillProblem {
+    static constexpr bool Forward = IsForward;
+    static constexpr bool Intersect = IsIntersect;
+    static constexpr bool GenKill = true;
+
+    const CFGIndex &cfg;
+    BitMatrix In, Out, Gen, Kill;
+    unsigned entry; // forward only
+
+    BitRow in(unsigned b) const { return In[b]; }
+    BitRow edgeIn(unsigned e, unsigned q) const { return Out[q]; }
+    template <unsigned Words> bool transfer(unsigned b) const {
+        return transferGenKill<Words>(Out[b], Gen[b], In[b], Kill[b]);
+    }
+    bool isBoundary(unsigned b) const {
+        return Forward ? b == entry : cfg.numSuccs(b) == 0 || !cfg.reachesExit[b];
+    }
+    void initBlock(unsigned b) const {
+        if (Intersect)
+            Out[b].set();
+        else
+            Out[b].reset();
+    }
+};
+
+typedef GenKillProblem<true, true> AvailProblem;   // AvailIn, AvailOut, DEExpr, ExprKill
+typedef GenKillProblem<false, true> AnticProblem;  // AntOut, AntIn, UEExpr, ExprKill
+
+// LaterIn(j) = INTERSECT(Later(i, j)), Later(i, j) = Earliest(i, j) + (LaterIn(i) - UEExpr(i)).
+// With LeanEarliest, Earliest(i, j) is evaluated from the block sets of i
+// and j whenever Later(i, j) is, and never stored.
+template <bool LeanEarliest> struct LaterProblem {
+    static constexpr bool Forward = true;
+    static constexpr bool Intersect = true;
+    static constexpr bool GenKill = false;
+
+    const CFGIndex &cfg;
+    const BlockSets &bsets;
+    const EdgeSets &esets;
+    unsigned entry;
+
+    BitRow in(unsigned b) const { return bsets.LaterIn[b]; }
+    BitRow edgeIn(unsigned e, unsigned q) const { return esets.Later[e]; }
+    template <unsigned Words> bool transfer(unsigned b) const {
+        bool changed = false;
+        for (unsigned e : cfg.succEdges(b)) {
+            if constexpr (LeanEarliest)
+                changed |= transferLaterEarliest<Words>(esets.Later[e], bsets.AntIn[cfg.edgeDst[e]],
+                                                        bsets.AvailOut[b], bsets.ExprKill[b],
+                                                        bsets.earliestAntOut(b, entry),
+                                                        bsets.LaterIn[b], bsets.UEExpr[b]);
+            else
+                changed |= transferLater<Words>(esets.Later[e], esets.Earliest[e], bsets.LaterIn[b], bsets.UEExpr[b]);
+        }
+        return changed;
+    }
+    bool isBoundary(unsigned b) const { return b == entry; }
+    void initBlock(unsigned b) const {}
+};
+
+// Later of the node formulation (-lcm-formulation=node). An edge i -> j
+// that is not critical leaves a block with one successor, and its Later is
+// LaterOut(i), or else enters a block with one predecessor, and its Later
+// is LaterIn(j): j adds Earliest(i, j) to LaterOut(i) = LaterIn(i) & ~UEExpr(i)
+// itself. Only the critical edges keep a row of their own, CritLater.
+// Such a j sets all of LaterIn(j) in its transfer, so its edge adds
+// nothing to the meet: were the meet to drop the Earliest bits the
+// transfer adds back, a cycle of such blocks (a self loop the entry does
+// not reach) would be revisited forever. LaterOut starts at the top, so
+// a pred not visited yet leaves LaterIn(j) at the top, as in the meet.
+struct NodeLaterProblem {
+    static constexpr bool Forward = true;
+    static constexpr bool Intersect = true;
+    static constexpr bool GenKill = false;
+
+    const CFGIndex &cfg;
+    const BlockSets &bsets;
+    BitMatrix CritLater;
+    ArrayRef<unsigned> critRow; // # of edge -> row of CritLater, ~0u if not critical
+    unsigned entry;
+
+    BitRow in(unsigned b) const { return bsets.LaterIn[b]; }
+    BitRow edgeIn(unsigned e, unsigned q) const {
+        if (critRow[e] != ~0u)
+            return CritLater[critRow[e]];
+        return cfg.numSuccs(q) == 1 ? bsets.LaterOut[q] : bsets.LaterIn[cfg.edgeDst[e]];
+    }
+    template <unsigned Words> bool transfer(unsigned b) const {
+        auto later = [&](BitRow Later, unsigned j) {
+            return transferLaterEarliest<Words>(Later, bsets.AntIn[j], bsets.AvailOut[b], bsets.ExprKill[b],
+                                                bsets.earliestAntOut(b, entry), bsets.LaterIn[b],
+                                                bsets.UEExpr[b]);
+        };
+        if (b != entry && cfg.numPreds(b) == 1) {
+            unsigned i = cfg.edgeSrc[cfg.predEdgesOf(b)[0]];
+            if (cfg.numSuccs(i) > 1) {
+                bsets.LaterIn[b].copy(bsets.LaterOut[i]);
+                orEarliest<Words>(bsets.LaterIn[b], bsets.AntIn[b], bsets.AvailOut[i],
+                                  bsets.ExprKill[i], bsets.earliestAntOut(i, entry));
+            }
+        }
+        if (cfg.numSuccs(b) == 1)
+            return later(bsets.LaterOut[b], cfg.edgeDst[cfg.succBegin[b]]);
+        bool changed = andNot<Words>(bsets.LaterOut[b], bsets.LaterIn[b], bsets.UEExpr[b]);
+        for (unsigned e : cfg.succEdges(b))
+            if (critRow[e] != ~0u)
+                changed |= later(CritLater[critRow[e]], cfg.edgeDst[e]);
+        return changed;
+    }
+    bool isBoundary(unsigned b) const { return b == entry; }
+    void initBlock(unsigned b) const { bsets.LaterOut[b].set(); }
+};
+
+// Per-direction state of the solver drivers, reused across functions
+struct SolveScratch {
+    Worklist worklist;
+    SCCOrder sccs;
+    LoopNest loops;
+    SmallVector<uint8_t, 32> visited;
+    bool irreducible = false; // elimination fell back to the worklist
+};
+
+// Block visits of each solver for the current function (-lcm-stats)
+struct SolveStats {
+    unsigned Exprs = 0; // before pruning to the candidates
+    unsigned Duplicates = 0; // removed by localCSE
+    unsigned AvailVisits = 0;
+    unsigned AntVisits = 0;
+    unsigned LaterVisits = 0;
+    bool AvailIrreducible = false; // -lcm-solver=elim fell back to the worklist
+    bool AntIrreducible = false;
+};
+
+// Wall-clock time of each phase of FunctionLCM::analyze, in microseconds.
+// Solves is the time of Avail and Antic together: their sum when they run
+// one after the other, about their maximum when they run concurrently.
+struct PhaseTimes {
+    uint64_t Nodes = 0;     // init, buildNodes, buildEdges
+    uint64_t LocalSets = 0;
+    uint64_t Avail = 0;
+    uint64_t Antic = 0;
+    uint64_t Solves = 0;
+    uint64_t Earliest = 0;
+    uint64_t Later = 0;
+    uint64_t InsertDelete = 0;
+    uint64_t Total = 0;
+};
+
+static uint64_t microseconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+/* Helper functions */
+
+void print_value(Value v) {
+	if (v.hasName())
+		errs() << v.getName();
+	else
+		errs() << v;
+}
+
+void print_bitvector(BitRow bv) {
+	// errs() is unbuffered: build the line first
+	int n = bv.size();
+	std::string line;
+	for(int i=0;i<n;i++) {
+		line += bv.test(i) ? '1' : '0';
+		if (!((i+1)%10))
+			line += ' ';
+	}
+	errs() << line <<" ("<<n<< ")\n";
+}
+
+void printBasicBlockInfo(BasicBlockInfo* bbinfo, const BlockSets &bsets, unsigned b) {
+	errs() << "> Block:\t";
+	errs() << *(bbinfo->B);
+	errs() << "Exprs:\t\t";
+	print_bitvector(bsets.Exprs[b]);
+	errs() << "ExprKill:\t";
+	print_bitvector(bsets.ExprKill[b]);
+	errs() << "DEExpr:\t\t";
+	print_bitvector(bsets.DEExpr[b]);
+	errs() << "UEExpr:\t\t";
+	print_bitvector(bsets.UEExpr[b]);
+
+	errs() << "AvailOut:\t";
+	print_bitvector(bsets.AvailOut[b]);
+	errs() << "AvailIn:\t";
+	print_bitvector(bsets.AvailIn[b]);
+	errs() << "AntOut:\t\t";
+	print_bitvector(bsets.AntOut[b]);
+	errs() << "AntIn:\t\t";
+	print_bitvector(bsets.AntIn[b]);
+
+	errs() << "LaterIn:\t";
+	print_bitvector(bsets.LaterIn[b]);
+	errs() << "Delete:\t\t";
+	print_bitvector(bsets.Delete[b]);
+}
+
+void print_edges(SmallVector<BBpair, 8> edges) {
+	for(auto &pair : edges) {
+		errs() << "(";
+		pair.first->printAsOperand(errs(), false);
+		errs() << ",";
+		pair.second->printAsOperand(errs(), false);
+		errs() << ") ";
+	}
+	errs() << "\n";
+}
+
+void printEdgeInfo(EdgeInfo* edgeinfo, const EdgeSets &esets, unsigned e) {
+	errs() << "(";
+	edgeinfo->edge.first->printAsOperand(errs(), false);
+	errs() << ",";
+	edgeinfo->edge.second->printAsOperand(errs(), false);
+	errs() << ")\n";
+
+	errs() << "Earliest:\t";
+	print_bitvector(esets.Earliest[e]);
+	errs() << "Later:\t\t";
+	print_bitvector(esets.Later[e]);
+	errs() << "Insert:\t\t";
+	print_bitvector(esets.Insert[e]);
+	errs() << "\n";
+}
+
+// Scratch of buildLocalSets, one per thread: # of value -> last scan that saw
+// it defined. Scan numbers are unique across threads and functions, so the
+// array only ever grows and is never cleared.
+static thread_local std::vector<uint64_t> DefStamp;
+static std::atomic<uint64_t> NextScan{0};
+
+/* FunctionLCM */
+// All LCM state of one function. Contexts of different functions share
+// nothing, so their analyses (analyze) can run concurrently; the debug dump
+// and the IR mutation (codeMotion) run on one thread, in function order.
+struct FunctionLCM {
+
+    // Expression related stuff
+    ExprTable exprtable; // Expression <-> # of expression in BitVectors
+    unsigned universe = 0; // candidates have IDs [0, universe), see buildNodes
+    // Instructions localCSE found to recompute an earlier one of their block,
+    // -> that one. They get no expression; codeMotion replaces them.
+    MapVector<Instruction*, Instruction*> duplicates;
+    ValueIndex values;
+    // # of expression of each non-ignored instruction, block by block:
+    // block b owns instExprs[instBegin[b] .. instBegin[b+1]); instrs holds
+    // the instructions themselves
+    SmallVector<unsigned, 128> instExprs;
+    SmallVector<Instruction*, 128> instrs;
+    SmallVector<unsigned, 33> instBegin;
+    // Occurrences of each candidate: the positions in instrs of expression
+    // id are occurs[occurBegin[id] .. occurBegin[id+1]), in block order
+    SmallVector<unsigned, 65> occurBegin;
+    SmallVector<unsigned, 128> occurs;
+
+    // CFG related stuff
+    CFGIndex cfg;
+    std::vector<BasicBlockInfo> bbinfos; // # of block -> BasicBlockInfo
+    std::vector<EdgeInfo> edgeinfos;     // # of edge -> EdgeInfo
+
+    // Bit-vector related stuff
+    BumpPtrAllocator arena; // all BitMatrix storage of the current function
+    BlockSets bsets;
+    EdgeSets esets;
+    // The sets hold the expressions [chunkBegin, chunkEnd). Unless the
+    // universe is solved in chunks (chunkWords != 0), that is all of them;
+    // else Insert and Delete are views of InsertAll and DeleteAll, which
+    // collect the results of every chunk.
+    unsigned chunkBegin = 0, chunkEnd = 0, chunkWords = 0;
+    BitMatrix InsertAll, DeleteAll;
+    MutableArrayRef<uint64_t> setWords; // storage of bsets and esets
+    // Lean mode (-lcm-lean), implied by the node formulation: no Earliest and
+    // Insert matrices; Insert of the whole universe lives in InsertRows, with
+    // rows for inserting edges only
+    bool lean = false;
+    SparseRowMatrix InsertRows;
+    // Node formulation (-lcm-formulation=node): esets.Later has a row per
+    // critical edge only, see NodeLaterProblem
+    bool node = false;
+    SmallVector<unsigned, 64> critRow; // # of edge -> row of esets.Later, ~0u if not critical
+#ifndef NDEBUG
+    // Edges and blocks where -lcm-cross-check found the formulations to differ
+    SmallVector<unsigned, 0> insertMismatches, deleteMismatches;
+#endif
+    SmallVector<uint8_t, 64> inserts; // # of edge -> Insert != {} in this chunk
+    // Insert and Delete as codeMotion reads them, built at the end of
+    // analyze; without the dump, the matrices are freed then
+    CompactRows insertBits, deleteBits;
+
+    SolveScratch fwd; // forward solves
+    SolveScratch bwd; // backward solve, may run next to buildAvailExpr
+    SolveStats stats;
+    PhaseTimes times;
+    unsigned fixedWords = 0; // row width the kernels are specialized for, 0 = any
+
+    // Set while analyzing a large function; nullptr runs everything inline
+    ThreadPool* pool = nullptr;
+    // Round of the current analysis (see -lcm-rounds), and whether the last
+    // codeMotion rewrote an operand of an instruction that could match
+    // another one now
+    unsigned round = 1;
+    bool regrouped = false;
+    bool splitEdges = false; // the last codeMotion changed the CFG
+    SmallVector<BasicBlock*, 8> splitBlocks; // by codeMotion, until foldSplitBlocks
+
+    void init(Function &F) {
+        exprtable.clear();
+        bbinfos.clear();
+        edgeinfos.clear();
+        arena.Reset();
+        stats = SolveStats();
+        times = PhaseTimes();
+#ifndef NDEBUG
+        insertMismatches.clear();
+        deleteMismatches.clear();
+#endif
+        cfg.build(F);
+    }
+
+    Value* leaderOf(Value* v) const {
+        if (auto* I = dyn_cast<Instruction>(v))
+            if (Instruction* leader = duplicates.lookup(I))
+                return leader;
+        return v;
+    }
+
+    // Local value numbering, one linear scan per block: an instruction with
+    // the same opcode, type, flags and (leader) operands as an earlier one of
+    // its block is a duplicate of it. A load only matches one with no write
+    // to memory in between. Only records the duplicates, since functions are
+    // analyzed concurrently; the IR is rewritten by codeMotion.
+    void localCSE(Function &F) {
+        duplicates.clear();
+        if (!LocalCSE)
+            return;
+        DenseMap<unsigned, SmallVector<std::pair<Instruction*, unsigned>, 1>> seen;
+        for (BasicBlock* B : cfg.blocks) {
+            seen.clear();
+            unsigned memgen = 0;
+            for (Instruction &I : *B) {
+                if (I.mayWriteToMemory())
+                    memgen++;
+                if (ignore_instr(&I) || isa<PHINode>(I) || isa<StoreInst>(I) || isa<FreezeInst>(I) ||
+                    I.mayHaveSideEffects() || I.isEHPad())
+                    continue;
+                if (auto* LI = dyn_cast<LoadInst>(&I); LI && !LI->isSimple())
+                    continue;
+                unsigned gen = isa<LoadInst>(I) ? memgen : 0;
+                hash_code h = hash_combine(I.getOpcode(), I.getType(), gen);
+                for (Value* op : I.operands())
+                    h = hash_combine(h, leaderOf(op));
+
+                // ~0u and ~0u - 1 are the empty and tombstone keys of the
+                // map: such a hash shares bucket 0, where same() tells them apart
+                unsigned key = (unsigned)h;
+                if (key == DenseMapInfo<unsigned>::getEmptyKey() ||
+                    key == DenseMapInfo<unsigned>::getTombstoneKey())
+                    key = 0;
+                auto &bucket = seen[key];
+                auto same = [&](std::pair<Instruction*, unsigned> x) {
+                    Instruction* J = x.first;
+                    if (x.second != gen || !I.isSameOperationAs(J) ||
+                        I.getRawSubclassOptionalData() != J->getRawSubclassOptionalData())
+                        return false;
+                    for (unsigned k = 0; k < I.getNumOperands(); k++)
+                        if (leaderOf(I.getOperand(k)) != leaderOf(J->getOperand(k)))
+                            return false;
+                    return true;
+                };
+                auto it = find_if(bucket, same);
+                if (it != bucket.end())
+                    duplicates[&I] = it->first;
+                else
+                    bucket.push_back(std::make_pair(&I, gen));
+            }
+        }
+        stats.Duplicates = duplicates.size();
+    }
+
+    void buildNodes(Function &F) {
+        // Visit every instruction once: intern its expression and cache the ID
+        unsigned nblocks = cfg.numBlocks();
+        bbinfos.resize(nblocks);
+        instExprs.clear();
+        instrs.clear();
+        instBegin.assign(nblocks + 1, 0);
+        for (unsigned b = 0; b < nblocks; b++) {
+            BasicBlockInfo &bbinfo = bbinfos[b];
+            bbinfo.B = cfg.blocks[b];
+            instBegin[b] = instExprs.size();
+
+            for(auto &I : *bbinfo.B) {
+                // Calls and allocas are kept for the values (and memory) they
+                // define; pruneCandidates drops them
+                if (I.isTerminator() || duplicates.count(&I))
+                    continue;
+
+                Expression expr = InstrToExpr(&I);
+                if (!duplicates.empty()) {
+                    for (Value* &op : expr.operands)
+                        op = leaderOf(op);
+                    expr.hash = hashExpr(expr);
+                }
+                instExprs.push_back(exprtable.insert(expr));
+                instrs.push_back(&I);
+            }
+        }
+        instBegin[nblocks] = instExprs.size();
+
+        pruneCandidates();
+        buildOccurrences();
+        values.build(exprtable, universe, instrs);
+    }
+
+    // Counting sort of the candidate positions in instExprs by expression
+    void buildOccurrences() {
+        occurBegin.assign(universe + 1, 0);
+        for (unsigned id : instExprs)
+            if (id < universe)
+                occurBegin[id + 1]++;
+        for (unsigned id = 0; id < universe; id++)
+            occurBegin[id + 1] += occurBegin[id];
+        occurs.resize(occurBegin[universe]);
+        SmallVector<unsigned, 65> fill(occurBegin.begin(), occurBegin.end() - 1);
+        for (unsigned k = 0; k < instExprs.size(); k++)
+            if (instExprs[k] < universe)
+                occurs[fill[instExprs[k]]++] = k;
+    }
+
+    ArrayRef<unsigned> occurrencesOf(unsigned id) const {
+        return ArrayRef<unsigned>(occurs).slice(occurBegin[id], occurBegin[id + 1] - occurBegin[id]);
+    }
+
+    // Choose how the sets are laid out for the formulation f, and allocate
+    // them
+    void allocSets(FormulationKind f) {
+        unsigned nblocks = cfg.numBlocks();
+        // Large universes may be solved in chunks of ChunkExprs (see
+        // analyzeChunks); the dump needs every set at once.
+        unsigned n = universe, words = (n + 63) / 64;
+        chunkWords = 0;
+        if (ChunkExprs && !DumpSets && n > ChunkExprs)
+            chunkWords = (ChunkExprs + 63) / 64;
+        node = f == FormulationKind::Node && !DumpSets;
+        lean = (Lean && !DumpSets) || node;
+        unsigned nlater = cfg.numEdges();
+        if (node) {
+            critRow.assign(cfg.numEdges(), ~0u);
+            nlater = 0;
+            for (unsigned e = 0; e < cfg.numEdges(); e++)
+                if (cfg.isCritical(e))
+                    critRow[e] = nlater++;
+        }
+
+        // Universes (or chunks) of up to 4 words get rows padded to 1, 2 or
+        // 4 words, and kernels specialized for that width (see analyze)
+        unsigned width = chunkWords ? chunkWords : words;
+        fixedWords = 0;
+        if (FixedWidth)
+            fixedWords = width <= 1 ? 1 : width <= 2 ? 2 : width <= 4 ? 4 : 0;
+        if (fixedWords)
+            width = fixedWords;
+        chunkBegin = 0;
+        chunkEnd = n;
+        if (!chunkWords) {
+            setWords = initBitMatrices(arena, bsets, nblocks, esets, nlater, n, width, lean, node);
+            if (lean)
+                InsertRows.init(arena, cfg.numEdges(), n, width);
+            return;
+        }
+        chunkWords = width;
+        setWords = initBitMatrices(arena, bsets, nblocks, esets, nlater, 64 * width, width, lean, node);
+        // Every chunk, the last one too, covers chunkWords whole words of a row
+        unsigned stride = alignTo(words, chunkWords);
+        if (lean)
+            InsertRows.init(arena, cfg.numEdges(), n, stride);
+        else
+            InsertAll = newBitMatrix(arena, cfg.numEdges(), n, stride);
+        DeleteAll = newBitMatrix(arena, nblocks, n, stride);
+    }
+
+    // Copy Insert and Delete to insertBits and deleteBits, and free the
+    // matrices unless the dump still needs them
+    void compactResults() {
+        insertBits.build(cfg.numEdges(), [&](unsigned e) { return lean ? InsertRows[e] : esets.Insert[e]; });
+        deleteBits.build(cfg.numBlocks(), [&](unsigned b) { return bsets.Delete[b]; });
+        if (!DumpSets) {
+            arena.Reset();
+            bsets = BlockSets();
+            esets = EdgeSets();
+            InsertRows = SparseRowMatrix();
+            setWords = MutableArrayRef<uint64_t>();
+        }
+    }
+
+    // Point the sets at the expressions [first, first + count)
+    void setChunk(unsigned first, unsigned count) {
+        BitMatrix* mats[] = {
+            &bsets.Exprs, &bsets.DEExpr, &bsets.UEExpr, &bsets.ExprKill,
+            &bsets.AvailOut, &bsets.AvailIn, &bsets.AntOut, &bsets.AntIn,
+            &bsets.LaterIn, &bsets.LaterOut, &esets.Earliest, &esets.Later,
+        };
+        for (BitMatrix* m : mats)
+            m->n = count;
+        if (!lean)
+            esets.Insert = InsertAll.columns(first, count);
+        bsets.Delete = DeleteAll.columns(first, count);
+        chunkBegin = first;
+        chunkEnd = first + count;
+    }
+
+    // Only an expression computed twice, or once on a cycle, can be partially
+    // redundant, and PHIs, calls, allocas and anything with side effects
+    // (stores, volatile or atomic loads) are never moved. Renumber the others
+    // past the candidates: they still define values, and so kill, but get
+    // no bit in the sets.
+    void pruneCandidates() {
+        unsigned nexprs = exprtable.size();
+        SmallVector<uint8_t, 33> inCycle;
+        cfg.markCycles(inCycle);
+        SmallVector<uint8_t, 128> seen(nexprs, 0); // 0, 1 = once, 2 = again or on a cycle
+        for (unsigned b = 0; b < cfg.numBlocks(); b++)
+            for (unsigned id : blockExprs(b))
+                seen[id] = (seen[id] || inCycle[b]) ? 2 : 1;
+
+        auto isCandidate = [&](unsigned id) {
+            Instruction* I = exprtable[id].I;
+            return seen[id] == 2 && !isa<PHINode>(I) && !ignore_instr(I) && !I->mayHaveSideEffects();
+        };
+        SmallVector<unsigned, 128> order;
+        order.reserve(nexprs);
+        for (unsigned id = 0; id < nexprs; id++)
+            if (isCandidate(id))
+                order.push_back(id);
+        universe = order.size();
+        stats.Exprs = nexprs;
+        if (universe == nexprs)
+            return;
+        for (unsigned id = 0; id < nexprs; id++)
+            if (!isCandidate(id))
+                order.push_back(id);
+        SmallVector<unsigned, 128> newid(nexprs);
+        for (unsigned k = 0; k < nexprs; k++)
+            newid[order[k]] = k;
+        exprtable.reorder(order);
+        for (unsigned &id : instExprs)
+            id = newid[id];
+    }
+
+    void buildEdges(Function &F) {
+        edgeinfos.resize(cfg.numEdges());
+        for (unsigned e = 0; e < cfg.numEdges(); e++) {
+            initEdgeInfo(&edgeinfos[e], std::make_pair(cfg.blocks[cfg.edgeSrc[e]], cfg.blocks[cfg.edgeDst[e]]));
+        }
+    }
+
+    // fn(i) for i in [0, n), in chunks of ParallelGrain on the pool if set.
+    // Calls must write disjoint rows.
+    template <typename Fn> void parallelFor(unsigned n, Fn fn) {
+        parallelFor(pool, n, std::max(1u, (unsigned)ParallelGrain), fn);
+    }
+
+    // fn(i) for i in [0, n) on p, or inline if p is null or n <= grain. Each
+    // worker takes the next chunk of grain items from a shared counter, so
+    // uneven items still keep all workers busy.
+    template <typename Fn> static void parallelFor(ThreadPool* p, unsigned n, unsigned grain, Fn fn) {
+        if (!p || n <= grain) {
+            for (unsigned i = 0; i < n; i++)
+                fn(i);
+            return;
+        }
+        std::atomic<unsigned> next{0};
+        unsigned workers = std::min(p->getThreadCount(), (n + grain - 1) / grain);
+        for (unsigned w = 0; w < workers; w++) {
+            p->async([&] {
+                for (unsigned begin; (begin = next.fetch_add(grain)) < n; ) {
+                    for (unsigned i = begin; i < std::min(n, begin + grain); i++)
+                        fn(i);
+                }
+            });
+        }
+        p->wait();
+    }
+
+    // SCC solver: visit(b) recomputes the sets of block b from its neighbors
+    // against the flow and returns whether its output changed. Every SCC is
+    // visited once if acyclic, else swept until nothing changes. The SCCs of
+    // one level are spread over p when they are big enough together.
+    // Returns the number of block visits.
+    template <typename Visit> static unsigned solveSCCs(const SCCOrder &order, ThreadPool* p, Visit visit) {
+        std::atomic<unsigned> visits{0};
+        for (unsigned l = 0; l < order.numLevels(); l++) {
+            unsigned first = order.levelBegin[l];
+            unsigned count = order.levelBegin[l + 1] - first;
+            unsigned size = order.sccBegin[first + count] - order.sccBegin[first];
+            parallelFor(size >= ParallelGrain ? p : nullptr, count, 1, [&](unsigned k) {
+                unsigned c = first + k, n = 0;
+                bool changed;
+                do {
+                    changed = false;
+                    for (unsigned b : order.membersOf(c)) {
+                        changed |= visit(b);
+                        n++;
+                    }
+                } while (changed && order.cyclic[c]);
+                visits.fetch_add(n, std::memory_order_relaxed);
+            });
+        }
+        return visits;
+    }
+
+    ArrayRef<unsigned> blockExprs(unsigned b) const {
+        return ArrayRef<unsigned>(instExprs).slice(instBegin[b], instBegin[b + 1] - instBegin[b]);
+    }
+
+    template <unsigned Words> void buildLocalSets(unsigned b) {
+        // For each block: Exprs, ExprKill, UEExpr in one forward scan and
+        // DEExpr in one backward scan over the cached expression IDs.
+        // A value is "defined" in the current scan if DefStamp[value] == scan.
+        std::vector<uint64_t> &defStamp = DefStamp;
+        if (defStamp.size() < values.numValues())
+            defStamp.resize(values.numValues(), 0);
+        BitRow Exprs = bsets.Exprs[b];
+        BitRow ExprKill = bsets.ExprKill[b];
+        BitRow UEExpr = bsets.UEExpr[b];
+        BitRow DEExpr = bsets.DEExpr[b];
+        Exprs.reset();
+        ExprKill.reset();
+        UEExpr.reset(); // first holds the expressions that are NOT upward exposed
+        DEExpr.reset(); // first holds the expressions that are NOT downward exposed
+
+        // UEExpr: "Not used after last change"
+		// the expression is evaluated BEFORE any (re)definition within the same block, 
+		// and its operands are not redefined before
+        // ExprKill: the block defines one of the expression's operands
+        uint64_t scan = NextScan.fetch_add(2, std::memory_order_relaxed) + 1;
+        auto inChunk = [&](unsigned id) { return id >= chunkBegin && id < chunkEnd; };
+        for (unsigned k = instBegin[b]; k < instBegin[b + 1]; k++) {
+            unsigned id = instExprs[k];
+            if (inChunk(id)) {
+                Exprs.set(id - chunkBegin);
+                for (unsigned v : values.operandsOf(id)) {
+                    if (defStamp[v] == scan)
+                        // operand defined before in this block
+                        UEExpr.set(id - chunkBegin);
+                }
+            }
+            auto define = [&](unsigned v) {
+                if (defStamp[v] == scan)
+                    return;
+                defStamp[v] = scan;
+                for (unsigned user : values.usersOf(v))
+                    if (inChunk(user))
+                        ExprKill.set(user - chunkBegin);
+            };
+            define(values.instDest[k]);
+            if (values.instClobbers[k])
+                define(values.memory);
+            if (values.instBarrier[k])
+                define(values.barrier);
+        }
+        andNot<Words>(UEExpr, Exprs, UEExpr);
+
+        // DEExpr: "Not changed after last use"
+		// the expression is evaluated AFTER (re)definition within the same block, 
+		// and its operands are not redefined afterwards
+        ++scan;
+        for (unsigned k = instBegin[b + 1]; k-- > instBegin[b]; ) {
+            unsigned id = instExprs[k];
+            for (unsigned v : inChunk(id) ? values.operandsOf(id) : ArrayRef<unsigned>()) {
+                if (defStamp[v] == scan)
+                    // operand defined afterwards in this block
+                    DEExpr.set(id - chunkBegin);
+            }
+            defStamp[values.instDest[k]] = scan;
+            if (values.instClobbers[k])
+                defStamp[values.memory] = scan;
+            if (values.instBarrier[k])
+                defStamp[values.barrier] = scan;
+        }
+        andNot<Words>(DEExpr, Exprs, DEExpr);
+    }
+
+    /* Dataflow engine */
+    // Solves Problem over the blocks of the function with the -lcm-solver
+    // driver. Each driver is written once here and specialized per Problem
+    // at compile time, so direction, meet and transfer inline into its loop.
+    // Problem provides:
+    //   Forward, Intersect  direction; meet is intersection or union
+    //   GenKill             transfer is Out = Gen | (In & ~Kill) over its
+    //                       matrices In, Out, Gen, Kill (allows elimination)
+    //   in(b)               the row the meet over b's preds writes
+    //   edgeIn(e, q)        what flows into in(b) along edge e from pred q
+    //   transfer(b)         recompute b's outputs from in(b); changed?
+    //   isBoundary(b)       in(b) is fixed to {}; solving starts there
+    //   initBlock(b)        initial value of b's outputs
+    // Preds along the flow are the CFG preds forward and the CFG succs
+    // backward. A pred takes part in a meet only once it has been visited.
+    // Every block is visited, also one the boundary does not reach (forward,
+    // one the entry does not reach): it gets the greatest fixed point from
+    // the top of the meet rather than the top itself, which its preds would
+    // never refine. Backward, the problem makes every block that cannot
+    // reach an exit a boundary instead.
+    // Returns the number of block visits (of function rows for elim).
+    template <unsigned Words, typename Problem>
+    unsigned solve(const Problem &P, SolveScratch &s, ThreadPool* p) {
+        constexpr bool Forward = Problem::Forward;
+        unsigned nblocks = cfg.numBlocks();
+        auto top = [](BitRow x) {
+            if constexpr (Problem::Intersect)
+                x.set();
+            else
+                x.reset();
+        };
+        auto meet = [](BitRow Dst, BitRow Src) {
+            if constexpr (Problem::Intersect)
+                return meetIntersect<Words>(Dst, Src);
+            else
+                return meetUnion<Words>(Dst, Src);
+        };
+        // fn(e, q) for the edges e from the preds / to the succs q of b
+        auto forPreds = [&](unsigned b, auto fn) {
+            if constexpr (Forward) {
+                for (unsigned e : cfg.predEdgesOf(b))
+                    fn(e, cfg.edgeSrc[e]);
+            } else {
+                for (unsigned e : cfg.succEdges(b))
+                    fn(e, cfg.edgeDst[e]);
+            }
+        };
+        auto forSuccs = [&](unsigned b, auto fn) {
+            if constexpr (Forward) {
+                for (unsigned e : cfg.succEdges(b))
+                    fn(e, cfg.edgeDst[e]);
+            } else {
+                for (unsigned e : cfg.predEdgesOf(b))
+                    fn(e, cfg.edgeSrc[e]);
+            }
+        };
+
+        // Init: in(n) = {} at the boundary, the top of the meet elsewhere
+        SmallVector<unsigned, 4> roots;
+        for (unsigned b = 0; b < nblocks; b++) {
+            P.initBlock(b);
+            if (P.isBoundary(b)) {
+                P.in(b).reset();
+                roots.push_back(b);
+            } else {
+                top(P.in(b));
+            }
+        }
+
+        s.irreducible = false;
+        if constexpr (Problem::GenKill && Problem::Intersect) {
+            if (Solver == SolverKind::Elimination) {
+                s.loops.build(cfg, Forward, roots);
+                if (s.loops.reducible)
+                    return solveElimination<Words>(s.loops, P.In, P.Out, P.Gen, P.Kill);
+                s.irreducible = true;
+            }
+        }
+
+        if (Solver == SolverKind::SCC) {
+            // visited is set concurrently by the SCCs of a level: one byte each
+            s.sccs.build(cfg, Forward, roots);
+            s.visited.assign(nblocks, 0);
+            return solveSCCs(s.sccs, p, [&](unsigned b) {
+                BitRow In = P.in(b);
+                if (!P.isBoundary(b)) {
+                    top(In);
+                    forPreds(b, [&](unsigned e, unsigned q) {
+                        if (s.visited[q])
+                            meet(In, P.edgeIn(e, q));
+                    });
+                }
+                bool first = !s.visited[b];
+                s.visited[b] = 1;
+                return P.template transfer<Words>(b) || first;
+            });
+        }
+
+        // worklist: push in successors every time -> guarantee that each block will
+        // be traversed after each of predecessor at least once.
+        // Visit in RPO (forward) or post-order (backward), so that a block
+        // usually sees all its predecessors first.
+        s.worklist.init(nblocks);
+        for (unsigned b = 0; b < nblocks; b++)
+            s.worklist.push(b);
+        unsigned visits = 0;
+        for (int b; (b = Forward ? s.worklist.popFirst() : s.worklist.popLast()) >= 0; ) {
+            visits++;
+            bool changed = P.template transfer<Words>(b);
+            forSuccs(b, [&](unsigned e, unsigned q) {
+                if (P.isBoundary(q))
+                    return;
+                if ((meet(P.in(q), P.edgeIn(e, b)) | changed) || !s.worklist.isVisited(q))
+                    s.worklist.push(q);
+            });
+        }
+        return visits;
+    }
+
+    // Elimination solver for Out = Gen | (In & ~Kill), In = INTERSECT(Out of the
+    // preds along the flow), In = {} at the roots, on a reducible nest.
+    // While a loop is solved, each of its blocks holds In(b) as a function
+    // G | (x & P) of the value x its header receives: G in In[b], P in Out[b].
+    // A loop's header starts as x itself; once the body is done, the back
+    // edges give In(h) = x & B(In(h)), whose greatest solution is
+    // x & (G_B | P_B), and it is substituted into the whole loop. The parent
+    // then substitutes x = INTERSECT(entry edges). Top-level functions are
+    // constants (P = {}), so finally In = G. Each block is rewritten once per
+    // enclosing loop. Returns the number of function rows built or rewritten.
+    template <unsigned Words>
+    unsigned solveElimination(const LoopNest &nest, BitMatrix In, BitMatrix Out,
+                              BitMatrix Gen, BitMatrix Kill) {
+        SmallVector<uint64_t, 16> scratch(4 * (size_t)In.stride);
+        BitRow AccG(scratch.data(), In.n), AccP(scratch.data() + In.stride, In.n);
+        BitRow TG(scratch.data() + 2 * In.stride, In.n), TP(scratch.data() + 3 * In.stride, In.n);
+        unsigned rows = 0;
+
+        // Acc = INTERSECT over the preds p of b through back edges (back) or
+        // the other edges (!back) of Out(p) = Gen(p) | (F_p & ~Kill(p))
+        auto meetPreds = [&](unsigned b, bool back) {
+            AccG.set(); // the constant {all}
+            AccP.reset();
+            for (unsigned p : nest.predsOf(b)) {
+                if (nest.isAncestor(b, p) != back)
+                    continue;
+                transferGenKill<Words>(TG, Gen[p], In[p], Kill[p]);
+                andNot<Words>(TP, Out[p], Kill[p]);
+                meetFunction<Words>(AccG, AccP, TG, TP);
+            }
+        };
+        // fn(b) for every block of the loop of h, inner loops included
+        auto forEachInLoop = [&](unsigned h, auto fn) {
+            SmallVector<unsigned, 16> stack(1, h);
+            while (!stack.empty()) {
+                unsigned b = stack.pop_back_val();
+                fn(b);
+                rows++;
+                if (nest.isHeader[b])
+                    stack.append(nest.bodyOf(b).begin(), nest.bodyOf(b).end());
+            }
+        };
+        // F_b from its preds; for an inner header, substitute into its loop
+        auto enter = [&](unsigned b) {
+            if (nest.isRoot[b]) {
+                In[b].reset();
+                Out[b].reset();
+                rows++;
+                return;
+            }
+            meetPreds(b, false);
+            if (!nest.isHeader[b]) {
+                In[b].copy(AccG);
+                Out[b].copy(AccP);
+                rows++;
+                return;
+            }
+            forEachInLoop(b, [&](unsigned x) { composeFunction<Words>(In[x], Out[x], AccG, AccP); });
+        };
+
+        for (unsigned h : nest.headers) {
+            // F_h = x, or the constant {} at a root
+            In[h].reset();
+            if (nest.isRoot[h])
+                Out[h].reset();
+            else
+                Out[h].set();
+            for (unsigned b : nest.bodyOf(h))
+                enter(b);
+            if (nest.isRoot[h])
+                continue;
+            meetPreds(h, true);
+            orRows<Words>(AccP, AccG, AccP);
+            forEachInLoop(h, [&](unsigned x) { meetIntersect<Words>(Out[x], AccP); });
+        }
+        for (unsigned b : nest.top)
+            enter(b);
+
+        for (unsigned b = 0; b < In.rows; b++) {
+            if (nest.covers(b))
+                transferGenKill<Words>(Out[b], Gen[b], In[b], Kill[b]);
+        }
+        return rows;
+    }
+
+    template <unsigned Words> void buildAvailExpr(Function &F) {
+        // Forward flow
+        // AvailOut = DEExpr + (AvailIn - ExprKill)
+        // AvailIn(n) = INTERSECT(AvailOut(m)) for m in preds(n), AvailIn(n_0) = {}
+        AvailProblem avail{cfg, bsets.AvailIn, bsets.AvailOut, bsets.DEExpr, bsets.ExprKill,
+                           cfg.indexOf(&(F.getEntryBlock()))};
+        // With concurrent solves the pool is busy with buildAnticiExpr
+        stats.AvailVisits += solve<Words>(avail, fwd, ConcurrentSolves ? nullptr : pool);
+        stats.AvailIrreducible |= fwd.irreducible;
+    }
+
+    template <unsigned Words> void buildAnticiExpr(Function &F) {
+        // Backward flow
+        // AntIn = UEExpr + (AntOut - ExprKill)
+        // AntOut(n) = INTERSECT(AntIn(m)) for m in succs(n), AntOut(n_f) = {}
+        AnticProblem antic{cfg, bsets.AntOut, bsets.AntIn, bsets.UEExpr, bsets.ExprKill, 0};
+        stats.AntVisits += solve<Words>(antic, bwd, ConcurrentSolves ? nullptr : pool);
+        stats.AntIrreducible |= bwd.irreducible;
+    }
+
+    template <unsigned Words> void buildAvailAntic(Function &F) {
+        // Both solves only read the local sets and write their own matrices
+        // (and worklists), so with a pool Antic runs on a worker meanwhile.
+        auto timed = [](uint64_t &us, auto solve) {
+            auto start = std::chrono::steady_clock::now();
+            solve();
+            us += microseconds(std::chrono::steady_clock::now() - start);
+        };
+        if (pool && ConcurrentSolves) {
+            pool->async([&] { timed(times.Antic, [&] { buildAnticiExpr<Words>(F); }); });
+            timed(times.Avail, [&] { buildAvailExpr<Words>(F); });
+            pool->wait();
+        } else {
+            timed(times.Avail, [&] { buildAvailExpr<Words>(F); });
+            timed(times.Antic, [&] { buildAnticiExpr<Words>(F); });
+        }
+    }
+
+    template <unsigned Words> void buildEarliest(Function &F) {
+        // For each edge
+        // Earliest(i, j) = (AntIn(j) - AvailOut(i)) & (ExprKill(i) + ~AntOut(i))
+        // Earliest(n_0, j) = AntIn(j) - AvailOut(n_0)
+        unsigned entry = cfg.indexOf(&(F.getEntryBlock()));
+        parallelFor(cfg.numEdges(), [&](unsigned e) {
+            unsigned i = cfg.edgeSrc[e];
+            unsigned j = cfg.edgeDst[e];
+            computeEarliest<Words>(esets.Earliest[e], bsets.AntIn[j], bsets.AvailOut[i],
+                            bsets.ExprKill[i], bsets.earliestAntOut(i, entry));
+        });
+    }
+
+    template <unsigned Words> void buildLater(Function &F) {
+        // Forward flow
+        // LaterIn(j) = INTERSECT(Later(i, j)) for i in pred(j), LaterIn(n_0) = {}
+        // Later(i, j) = Earliest(i, j) + (LaterIn(i) - UEExpr(i))
+        unsigned entry = cfg.indexOf(&(F.getEntryBlock()));
+        if (node)
+            stats.LaterVisits += solve<Words>(NodeLaterProblem{cfg, bsets, esets.Later, critRow, entry}, fwd, pool);
+        else if (lean)
+            stats.LaterVisits += solve<Words>(LaterProblem<true>{cfg, bsets, esets, entry}, fwd, pool);
+        else
+            stats.LaterVisits += solve<Words>(LaterProblem<false>{cfg, bsets, esets, entry}, fwd, pool);
+    }
+
+    // Later(i, j) of edge e. The node formulation keeps it for the critical
+    // edges, and as LaterOut(i) if i has one successor; else j has one
+    // predecessor, and Later(i, j) = LaterIn(j), so Insert(i, j) = {}.
+    BitRow laterOf(unsigned e) const {
+        if (!node)
+            return esets.Later[e];
+        if (critRow[e] != ~0u)
+            return esets.Later[critRow[e]];
+        unsigned i = cfg.edgeSrc[e];
+        return cfg.numSuccs(i) == 1 ? bsets.LaterOut[i] : bsets.LaterIn[cfg.edgeDst[e]];
+    }
+
+    template <unsigned Words> void buildInsertDelete(Function &F) {
+        // For each block / edge
+        // Insert(i, j) = Later(i, j) - LaterIn(j)
+
+        if (!lean) {
+            parallelFor(cfg.numEdges(), [&](unsigned e) {
+                andNot<Words>(esets.Insert[e], esets.Later[e], bsets.LaterIn[cfg.edgeDst[e]]);
+            });
+        } else {
+            // Find the inserting edges, give them a row (the arena is not
+            // thread-safe), then fill the rows
+            inserts.resize(cfg.numEdges());
+            parallelFor(cfg.numEdges(), [&](unsigned e) {
+                inserts[e] = anyAndNot<Words>(laterOf(e), bsets.LaterIn[cfg.edgeDst[e]]);
+            });
+            for (unsigned e = 0; e < cfg.numEdges(); e++)
+                if (inserts[e])
+                    InsertRows.alloc(arena, e);
+            parallelFor(cfg.numEdges(), [&](unsigned e) {
+                if (inserts[e])
+                    andNot<Words>(InsertRows.columns(e, chunkBegin, chunkEnd - chunkBegin),
+                                  laterOf(e), bsets.LaterIn[cfg.edgeDst[e]]);
+            });
+        }
+
+        // Delete(i) = UEExpr(i) - LaterIn(i), i != n_0
+        //             {}, i = n_0
+
+        parallelFor(cfg.numBlocks(), [&](unsigned b) {
+            if (bbinfos[b].B != &(F.getEntryBlock()))
+                andNot<Words>(bsets.Delete[b], bsets.UEExpr[b], bsets.LaterIn[b]);
+            else
+                bsets.Delete[b].reset();
+        });
+
+    }
+
+    // Rewrite F; DT and LI, if not null, are kept up to date with the
+    // blocks it splits. Returns whether F changed.
+    int codeMotion(Function &F, DominatorTree* DT, LoopInfo* LI) {
+
+        regrouped = false;
+        splitEdges = false;
+
+        // Local duplicates
+        for (auto &dup : duplicates) {
+            dup.first->replaceAllUsesWith(dup.second);
+            dup.first->eraseFromParent();
+        }
+
+        // Where each inserting edge (i, j) computes: at the end of i if j is
+        // its only successor, else in a new block on the edge. (Insert is {}
+        // on an edge into a block with one predecessor: LaterIn of the block
+        // is Later of the edge.) All edges are split first, so that the
+        // SSAUpdater below sees the final CFG, and the dominator tree gets
+        // the splits as one batch.
+        SmallVector<DominatorTree::UpdateType, 16> cfgUpdates;
+        SmallVector<Instruction*, 64> insertPt(cfg.numEdges(), nullptr);
+        BitVector moved(universe);
+        for (unsigned e = 0; e < cfg.numEdges(); e++) {
+            EdgeInfo* edgeinfo = &edgeinfos[e];
+            if (insertBits.empty(e))
+                continue;
+            insertBits.forEach(e, [&](unsigned idx) { moved.set(idx); });
+
+            BasicBlock* i = edgeinfo->start;
+            BasicBlock* j = edgeinfo->end;
+            if (i->getUniqueSuccessor()) {
+                insertPt[e] = i->getTerminator();
+                continue;
+            }
+            // split edge (i, j): every successor slot of i that is j moves to
+            // the new block, and the PHIs of j get i's value from it, once
+            assert(!j->getSinglePredecessor() && "Insert on an edge into a block with one predecessor");
+            BasicBlock* newBlock = BasicBlock::Create(F.getContext(), "newblock"+std::to_string(splitBlocks.size()));
+            placeSplitBlock(F, newBlock, i, j);
+            splitBlocks.push_back(newBlock);
+            edgeinfo->InsertBlock = newBlock;
+            Instruction *terminator = i->getTerminator();
+            for (unsigned s = 0; s < terminator->getNumSuccessors(); s++) {
+                if (terminator->getSuccessor(s) == j)
+                    terminator->setSuccessor(s, newBlock);
+            }
+            for (PHINode &phi : j->phis()) {
+                unsigned first = phi.getBasicBlockIndex(i);
+                for (unsigned k = phi.getNumIncomingValues() - 1; k > first; k--) {
+                    if (phi.getIncomingBlock(k) == i)
+                        phi.removeIncomingValue(k, false);
+                }
+                phi.setIncomingBlock(first, newBlock);
+            }
+            insertPt[e] = BranchInst::Create(j, newBlock);
+            cfgUpdates.push_back({DominatorTree::Insert, i, newBlock});
+            cfgUpdates.push_back({DominatorTree::Insert, newBlock, j});
+            cfgUpdates.push_back({DominatorTree::Delete, i, j});
+            // the new block is on a cycle of the innermost loop with both ends
+            if (LI) {
+                Loop* L = LI->getLoopFor(i);
+                while (L && !L->contains(j))
+                    L = L->getParentLoop();
+                if (L)
+                    L->addBasicBlockToLoop(newBlock, *LI);
+            }
+        }
+        if (!cfgUpdates.empty()) {
+            DomTreeUpdater DTU(DT, DomTreeUpdater::UpdateStrategy::Lazy);
+            DTU.applyUpdates(cfgUpdates);
+            DTU.flush();
+            splitEdges = true;
+        }
+
+        // Each moved expression gets one temporary. The occurrences that
+        // stay define it, and so do the inserted clones, which come last in
+        // their block; the occurrence Delete removes from a block is its
+        // first one (the upward-exposed one: Delete is in UEExpr), and reads
+        // the temporary at the start of the block. defs and uses pair an
+        // expression with those.
+        SmallVector<std::pair<unsigned, Instruction*>, 32> defs, uses;
+        BitVector deleted(instrs.size());
+        for (unsigned b = 0; b < cfg.numBlocks(); b++) {
+            deleteBits.forEach(b, [&](unsigned idx) {
+                moved.set(idx);
+                ArrayRef<unsigned> occ = occurrencesOf(idx);
+                // Delete is in UEExpr, so the block has an occurrence; if the
+                // sets ever disagree with the IR, stop rather than read past
+                // the list or delete an occurrence of another block
+                auto it = std::lower_bound(occ.begin(), occ.end(), instBegin[b]);
+                if (it == occ.end() || *it >= instBegin[b + 1])
+                    report_fatal_error("LCM: Delete outside UEExpr in " + F.getName());
+                unsigned k = *it;
+                deleted.set(k);
+                uses.push_back(std::make_pair(idx, instrs[k]));
+            });
+        }
+        for (unsigned idx : moved.set_bits())
+            for (unsigned k : occurrencesOf(idx))
+                if (!deleted.test(k))
+                    defs.push_back(std::make_pair(idx, instrs[k]));
+        for (unsigned e = 0; e < cfg.numEdges(); e++) {
+            insertBits.forEach(e, [&](unsigned idx) {
+                Instruction* cloned_instr = exprtable[idx].I->clone();
+                cloned_instr->insertBefore(insertPt[e]);
+                defs.push_back(std::make_pair(idx, cloned_instr));
+            });
+        }
+
+        // SSAUpdater keeps the last value added for a block, which is the
+        // one live at its end
+        auto byExpr = [](const std::pair<unsigned, Instruction*> &x, const std::pair<unsigned, Instruction*> &y) {
+            return x.first < y.first;
+        };
+        llvm::stable_sort(defs, byExpr);
+        llvm::stable_sort(uses, byExpr);
+        auto def = defs.begin();
+        for (auto use = uses.begin(); use != uses.end(); ) {
+            unsigned idx = use->first;
+            Instruction* I = exprtable[idx].I;
+            SSAUpdater temp;
+            temp.Initialize(I->getType(), I->getName());
+            for (; def != defs.end() && def->first <= idx; ++def) {
+                if (def->first == idx)
+                    temp.AddAvailableValue(def->second->getParent(), def->second);
+            }
+            for (; use != uses.end() && use->first == idx; ++use) {
+                Instruction* occurrence = use->second;
+                // its users now read the temporary: t * c over a hoisted t
+                // is one expression with the other t * c next round
+                for (User* U : occurrence->users())
+                    if (isLexical(cast<Instruction>(U)))
+                        regrouped = true;
+                occurrence->replaceAllUsesWith(temp.GetValueInMiddleOfBlock(occurrence->getParent()));
+                occurrence->eraseFromParent();
+            }
+        }
+
+        return !duplicates.empty() || moved.any();
+    }
+
+    // Lay out the block splitting (i, j) so that no fallthrough is lost:
+    // in front of j, unless the block there falls through into j; else
+    // right after i, unless i falls through into that block; else at the
+    // end. (In front of i, it would become the entry if i is.) When the
+    // branch weights of i say which way is hot, they decide instead: the
+    // hot edge falls through from i into the new block, and the new block
+    // of a cold edge goes to the end, out of the way of the hot path.
+    static void placeSplitBlock(Function &F, BasicBlock* newBlock, BasicBlock* i, BasicBlock* j) {
+        BasicBlock* prev = j->getPrevNode();
+        BasicBlock* next = i->getNextNode();
+        SmallVector<uint32_t, 4> weights;
+        if (extractBranchWeights(*i->getTerminator(), weights)) {
+            // j may take several slots of a switch, and so may the others
+            SmallDenseMap<BasicBlock*, uint64_t, 4> weightOf;
+            for (unsigned s = 0; s < weights.size(); s++)
+                weightOf[i->getTerminator()->getSuccessor(s)] += weights[s];
+            uint64_t hottest = 0;
+            for (auto &succ : weightOf)
+                if (succ.first != j)
+                    hottest = std::max(hottest, succ.second);
+            if (weightOf[j] > hottest) {
+                newBlock->insertInto(&F, next);
+                return;
+            }
+            if (weightOf[j] < hottest) {
+                newBlock->insertInto(&F);
+                return;
+            }
+        }
+        if (prev == i || !is_contained(successors(prev), j))
+            newBlock->insertInto(&F, j);
+        else if (!next || !is_contained(successors(i), next))
+            newBlock->insertInto(&F, next);
+        else
+            newBlock->insertInto(&F);
+    }
+
+    // Remove the split blocks a later round left with nothing but their
+    // branch: i branches to j again. DT and LI as for codeMotion.
+    // A split block that is not empty cannot be merged into its neighbours:
+    // i has several successors, or the edge would not have been split, and
+    // j has several predecessors, as Insert is {} on an edge into a block
+    // with one (codeMotion asserts both).
+    void foldSplitBlocks(DominatorTree* DT, LoopInfo* LI) {
+        DomTreeUpdater DTU(DT, DomTreeUpdater::UpdateStrategy::Lazy);
+        for (BasicBlock* S : splitBlocks) {
+            if (S->size() != 1)
+                continue;
+            // as in the split, but backwards: j gets an entry per slot of i
+            BasicBlock* i = S->getUniquePredecessor();
+            BasicBlock* j = S->getSingleSuccessor();
+            unsigned slots = pred_size(S);
+            i->getTerminator()->replaceSuccessorWith(S, j);
+            for (PHINode &phi : j->phis()) {
+                Value* v = phi.getIncomingValueForBlock(S);
+                phi.setIncomingBlock(phi.getBasicBlockIndex(S), i);
+                for (unsigned k = 1; k < slots; k++)
+                    phi.addIncoming(v, i);
+            }
+            DTU.applyUpdates({{DominatorTree::Delete, i, S},
+                              {DominatorTree::Delete, S, j},
+                              {DominatorTree::Insert, i, j}});
+            if (LI)
+                LI->removeBlock(S);
+            DTU.deleteBB(S);
+        }
+        DTU.flush();
+        splitBlocks.clear();
+    }
+
+    // Everything up to Insert/Delete; reads the IR of F only
+    void analyze(Function &F) {
+        auto start = std::chrono::steady_clock::now(), last = start;
+        auto lap = [&](uint64_t &us) {
+            auto now = std::chrono::steady_clock::now();
+            us += microseconds(now - last);
+            last = now;
+        };
+
+        init(F);
+        localCSE(F);
+        buildNodes(F);
+        buildEdges(F);
+        allocSets(Formulation);
+        lap(times.Nodes);
+
+        // No candidates: every set stays empty
+        if (universe == 0) {
+            compactResults();
+            times.Total = microseconds(last - start);
+            return;
+        }
+        solveSets(F, lap);
+        compactResults();
+        lap(times.InsertDelete);
+#ifndef NDEBUG
+        if (CrossCheck && !DumpSets)
+            crossCheck(F);
+#endif
+        times.Total = microseconds(last - start);
+    }
+
+    // Local sets up to Insert/Delete, at once or chunk by chunk
+    template <typename Lap> void solveSets(Function &F, Lap &lap) {
+        if (!chunkWords) {
+            analyzeSets(F, lap);
+            return;
+        }
+        // One chunk at a time, on the same matrices
+        for (unsigned first = 0; first < universe; first += 64 * chunkWords) {
+            std::fill(setWords.begin(), setWords.end(), 0);
+            setChunk(first, std::min(universe - first, 64 * chunkWords));
+            analyzeSets(F, lap);
+        }
+        esets.Insert = InsertAll;
+        bsets.Delete = DeleteAll;
+    }
+
+#ifndef NDEBUG
+    // Solve F again with the other formulation, and record the edges and
+    // blocks where its Insert or Delete differ (print reports them). The
+    // results, stats and times of the first solve are kept.
+    void crossCheck(Function &F) {
+        CompactRows insert = std::move(insertBits), del = std::move(deleteBits);
+        SolveStats s = stats;
+        PhaseTimes t = times;
+        bool wasNode = node, wasLean = lean;
+        auto noLap = [](uint64_t &) {};
+
+        allocSets(node ? FormulationKind::Edge : FormulationKind::Node);
+        solveSets(F, noLap);
+        compactResults();
+        insertMismatches.clear();
+        deleteMismatches.clear();
+        for (unsigned e = 0; e < cfg.numEdges(); e++)
+            if (!insert.sameRow(insertBits, e))
+                insertMismatches.push_back(e);
+        for (unsigned b = 0; b < cfg.numBlocks(); b++)
+            if (!del.sameRow(deleteBits, b))
+                deleteMismatches.push_back(b);
+
+        insertBits = std::move(insert);
+        deleteBits = std::move(del);
+        stats = s;
+        times = t;
+        node = wasNode;
+        lean = wasLean;
+    }
+#endif
+
+    // analyzeSets<Words> for the row width of this function
+    template <typename Lap> void analyzeSets(Function &F, Lap &lap) {
+        switch (fixedWords) {
+        case 1: analyzeSets<1>(F, lap); break;
+        case 2: analyzeSets<2>(F, lap); break;
+        case 4: analyzeSets<4>(F, lap); break;
+        default: analyzeSets<0>(F, lap); break;
+        }
+    }
+
+    // Local sets up to Insert/Delete, with rows of Words words (0 = any)
+    template <unsigned Words, typename Lap> void analyzeSets(Function &F, Lap &lap) {
+        parallelFor(cfg.numBlocks(), [&](unsigned b) { buildLocalSets<Words>(b); });
+        lap(times.LocalSets);
+        buildAvailAntic<Words>(F);
+        lap(times.Solves);
+
+        if (!lean) // else evaluated by buildLater
+            buildEarliest<Words>(F);
+        lap(times.Earliest);
+        buildLater<Words>(F);
+        lap(times.Later);
+        buildInsertDelete<Words>(F);
+        lap(times.InsertDelete);
+    }
+
+    std::string roundSuffix() const {
+        return round > 1 ? " (round " + std::to_string(round) + ")" : "";
+    }
+
+    void print(Function &F) {
+        /* Print out for debug*/
+        if (DumpSets) {
+            for (auto &B : F) {
+                unsigned b = cfg.indexOf(&B);
+                printBasicBlockInfo(&bbinfos[b], bsets, b);
+            }
+            for (auto &B : F) {
+                for (unsigned e : cfg.succEdges(cfg.indexOf(&B)))
+                    printEdgeInfo(&edgeinfos[e], esets, e);
+            }
+        }
+
+        if (PrintStats) {
+            errs() << "LCM stats " << F.getName() << roundSuffix() << ": " << cfg.numBlocks() << " blocks, "
+                   << cfg.numEdges() << " edges, " << stats.Exprs << " exprs, " << universe
+                   << " candidates, " << stats.Duplicates << " local duplicates; visits: avail "
+                   << stats.AvailVisits << ", antic " << stats.AntVisits << ", later "
+                   << stats.LaterVisits
+                   << (stats.AvailIrreducible ? " (avail: irreducible, worklist)" : "")
+                   << (stats.AntIrreducible ? " (antic: irreducible, worklist)" : "")
+                   << "; insert/delete: " << insertBits.denseRows + deleteBits.denseRows << " of "
+                   << cfg.numEdges() + cfg.numBlocks() << " rows dense, "
+                   << insertBits.bytes() + deleteBits.bytes() << " bytes\n";
+        }
+
+#ifndef NDEBUG
+        if (!insertMismatches.empty() || !deleteMismatches.empty()) {
+            std::string line;
+            raw_string_ostream os(line);
+            os << "LCM cross-check " << F.getName() << ": the edge and node formulations differ";
+            for (unsigned e : insertMismatches) {
+                os << "; Insert of ";
+                cfg.blocks[cfg.edgeSrc[e]]->printAsOperand(os, false);
+                os << " -> ";
+                cfg.blocks[cfg.edgeDst[e]]->printAsOperand(os, false);
+            }
+            for (unsigned b : deleteMismatches) {
+                os << "; Delete of ";
+                cfg.blocks[b]->printAsOperand(os, false);
+            }
+            errs() << os.str() << "\n";
+        }
+#endif
+
+        if (PrintTimes) {
+            errs() << "LCM times " << F.getName() << roundSuffix() << " (us): nodes " << times.Nodes
+                   << ", local sets " << times.LocalSets << ", avail " << times.Avail
+                   << ", antic " << times.Antic << ", avail+antic " << times.Solves
+                   << ", earliest " << times.Earliest << ", later " << times.Later
+                   << ", insert/delete " << times.InsertDelete << ", total " << times.Total << "\n";
+        }
+    }
+};
+
+struct LCMPass : public PassInfoMixin<LCMPass> {
+
+    PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM) {
+        // The dump prints every set of every edge, so it needs them all
+        // stored at once: say so for the options that would not
+        if (DumpSets) {
+            auto ignored = [](bool set, StringRef option) {
+                if (set)
+                    errs() << "warning: " << option << " is ignored with -lcm-dump-sets\n";
+            };
+            ignored(ChunkExprs != 0, "-lcm-chunk-exprs");
+            ignored(Lean, "-lcm-lean");
+            ignored(Formulation == FormulationKind::Node, "-lcm-formulation=node");
+#ifndef NDEBUG
+            ignored(CrossCheck, "-lcm-cross-check");
+#endif
+        }
+
+        SmallVector<Function*, 16> functions;
+        for (auto &F : M) {
+        	// errs() << F.getName() << " " << F.size() << "\n";
+        	// errs() << F << "\n";
+
+			if (F.isDeclaration()) // exclude external functions
+				continue;
+			if (F.empty()) {
+				// errs() << "No entry block found.\n";
+				continue;
+			}
+            functions.push_back(&F);
+        }
+
+        // Function analyses cached by earlier passes: the dominator tree and
+        // loop info are updated with the split edges, the rest is dropped
+        // where F changed
+        FunctionAnalysisManager &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+        int changed = 0;
+        auto finish = [&](Function &F, FunctionLCM &lcm) {
+            lcm.print(F);
+            DominatorTree* DT = FAM.getCachedResult<DominatorTreeAnalysis>(F);
+            LoopInfo* LI = FAM.getCachedResult<LoopAnalysis>(F);
+            int this_changed = lcm.codeMotion(F, DT, LI);
+            bool split = lcm.splitEdges;
+            // Later rounds analyze F again, inline
+            for (lcm.round = 2; lcm.regrouped && lcm.round <= Rounds; lcm.round++) {
+                lcm.analyze(F);
+                lcm.print(F);
+                this_changed |= lcm.codeMotion(F, DT, LI);
+                split |= lcm.splitEdges;
+            }
+            lcm.round = 1;
+            lcm.foldSplitBlocks(DT, LI);
+            changed |= this_changed;
+            if (this_changed) {
+                PreservedAnalyses PA;
+                if (split) {
+                    PA.preserve<DominatorTreeAnalysis>();
+                    PA.preserve<LoopAnalysis>();
+                } else {
+                    PA.preserveSet<CFGAnalyses>();
+                }
+                FAM.invalidate(F, PA);
+            }
+            // errs() << F << "\n";
+        };
+        // The function analyses are invalidated above, one function at a time
+        auto preserved = [&] {
+            if (!changed)
+                return PreservedAnalyses::all();
+            PreservedAnalyses PA;
+            PA.preserveSet<AllAnalysesOn<Function>>();
+            PA.preserve<FunctionAnalysisManagerModuleProxy>();
+            return PA;
+        };
+
+        if (Threads == 1) {
+            FunctionLCM lcm;
+            for (Function* F : functions) {
+                lcm.analyze(*F);
+                finish(*F, lcm);
+            }
+            return preserved();
+        }
+
+        // Analyze a window of functions in parallel, then print and move code
+        // serially in function order, so the output matches the serial mode.
+        // Large functions are left out of the window and analyzed afterwards
+        // one at a time, spreading their blocks and edges over the pool instead
+        // (a task must not wait on the pool it runs on).
+        ThreadPool pool(hardware_concurrency(Threads));
+        unsigned window = 4 * pool.getThreadCount();
+        std::vector<FunctionLCM> contexts(std::min<size_t>(window, functions.size()));
+        auto isLarge = [](Function* F) { return F->size() >= ParallelBlocks; };
+        for (size_t first = 0; first < functions.size(); first += window) {
+            size_t last = std::min(first + window, functions.size());
+            for (size_t f = first; f < last; f++) {
+                FunctionLCM* lcm = &contexts[f - first];
+                Function* F = functions[f];
+                if (!isLarge(F))
+                    pool.async([lcm, F] { lcm->analyze(*F); });
+            }
+            pool.wait();
+            for (size_t f = first; f < last; f++) {
+                FunctionLCM &lcm = contexts[f - first];
+                if (!isLarge(functions[f]))
+                    continue;
+                lcm.pool = &pool;
+                lcm.analyze(*functions[f]);
+                lcm.pool = nullptr;
+            }
+            for (size_t f = first; f < last; f++)
+                finish(*functions[f], contexts[f - first]);
+        }
+
+        return preserved();
+    };
+};
+
+}
+
+extern "C" LLVM_ATTRIBUTE_WEAK ::llvm::PassPluginLibraryInfo
+llvmGetPassPluginInfo() {
+    return {
+        .APIVersion = LLVM_PLUGIN_API_VERSION,
+        .PluginName = "LCM pass",
+        .PluginVersion = "v0.1",
+        .RegisterPassBuilderCallbacks = [](PassBuilder &PB) {
+            PB.registerPipelineStartEPCallback(
+                [](ModulePassManager &MPM, OptimizationLevel Level) {
+                    MPM.addPass(LCMPass());
+                });
+        }
+    };
+}
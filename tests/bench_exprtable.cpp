@@ -0,0 +1,74 @@
+// Microbenchmark of expression interning: for every function of an IR file,
+// intern and look up every expression, as buildNodes does, with the old
+// std::map<Expression, unsigned> and with ExprTable. Built and run by
+// tests/bench_exprtable.sh against the ExprTable.h the pass uses.
+
+#include "../src/ExprTable.h"
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <map>
+
+using namespace lcm;
+
+static uint64_t microseconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+void benchExprTable(Function &F) {
+    const int rounds = 100;
+    SmallVector<Expression, 128> instrs;
+    for (auto &B : F)
+        for (auto &I : B)
+            if (!I.isTerminator()) // as buildNodes
+                instrs.push_back(InstrToExpr(&I));
+
+    using clock = std::chrono::steady_clock;
+    unsigned long sum_map = 0, sum_table = 0;
+
+    auto start = clock::now();
+    for (int r = 0; r < rounds; r++) {
+        std::map<Expression, unsigned> exprmap;
+        for (auto &expr : instrs)
+            exprmap.insert(std::make_pair(expr, exprmap.size()));
+        for (auto &expr : instrs)
+            sum_map += exprmap[expr];
+    }
+    auto mid = clock::now();
+    for (int r = 0; r < rounds; r++) {
+        ExprTable exprtable;
+        exprtable.clear();
+        for (auto &expr : instrs)
+            exprtable.insert(expr);
+        for (auto &expr : instrs)
+            sum_table += exprtable.lookup(expr);
+    }
+    auto end = clock::now();
+
+    outs() << "ExprTable bench " << F.getName() << ": " << instrs.size()
+           << " instrs x " << rounds << " rounds, std::map " << microseconds(mid - start)
+           << " us, ExprTable " << microseconds(end - mid) << " us"
+           << (sum_map == sum_table ? "" : " (MISMATCH)") << "\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        errs() << "usage: " << argv[0] << " input.ll\n";
+        return 1;
+    }
+    LLVMContext context;
+    SMDiagnostic err;
+    std::unique_ptr<Module> M = parseIRFile(argv[1], err, context);
+    if (!M) {
+        err.print(argv[0], errs());
+        return 1;
+    }
+    for (Function &F : *M)
+        if (!F.isDeclaration())
+            benchExprTable(F);
+    return 0;
+}
@@ -0,0 +1,11 @@
+# Expression interning microbenchmark: build tests/bench_exprtable.cpp
+# against LLVM and time std::map against ExprTable on every function of the
+# given IR files.
+#   $ bash tests/bench_exprtable.sh input.ll ...
+bin=bench_exprtable
+clang++ -O2 $(llvm-config --cxxflags) -o ${bin} tests/bench_exprtable.cpp \
+    $(llvm-config --ldflags --libs) -lpthread || exit 1
+for f in "$@"; do
+    ./${bin} ${f}
+done
+rm -f ${bin}
@@ -1,7 +1,10 @@
-rm -r tests/llvm-pass-skeleton/build
+# Build the pass in tests/llvm-pass-skeleton/build, or in the folder given
+# as $1 with the C++ flags given as $2 (see tests/vector_kernels.sh)
+build=${1:-build}
+rm -r tests/llvm-pass-skeleton/${build}
 cd tests/llvm-pass-skeleton
-mkdir build
-cd build
-cmake ..
+mkdir ${build}
+cd ${build}
+cmake -DCMAKE_CXX_FLAGS="$2" ..
 make
-cd ..
\ No newline at end of file
+cd ..
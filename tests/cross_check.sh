@@ -0,0 +1,21 @@
+# Node vs. edge formulation: solve every function of the single-source
+# benchmarks of the test suite both ways (-lcm-cross-check), and print the
+# functions whose Insert or Delete differ. -lcm-cross-check only exists in
+# builds with assertions.
+PASS=tests/llvm-pass-skeleton/build/LCM/LCMPass.so
+tmp=cross_check.ll
+files=0
+failed=0
+for src in $(find tests/test-suite/SingleSource/Benchmarks -name '*.c'); do
+    clang -O0 -Xclang -disable-O0-optnone -S -emit-llvm -w -o ${tmp} ${src} 2>/dev/null || continue
+    files=$((files + 1))
+    diffs=$(opt -load ${PASS} -load-pass-plugin ${PASS} -passes='function(mem2reg),default<O0>' \
+        -lcm-cross-check -disable-output ${tmp} 2>&1 | grep '^LCM cross-check')
+    if [ -n "${diffs}" ]; then
+        echo "${src}:"
+        echo "${diffs}"
+        failed=$((failed + 1))
+    fi
+done
+rm -f ${tmp}
+echo "${failed} of ${files} files differ"
@@ -0,0 +1,37 @@
+# Large-CFG test: a generated switch with one case (block) per state,
+# analyzed with 1 thread and with all cores. Above -lcm-parallel-blocks the
+# local sets and the per-edge equations are split over the thread pool.
+# mem2reg first, so that the address computations the cases share are
+# candidates. With all cores, -lcm-time also gives the time of the
+# availability and anticipation solves, run concurrently and one after the
+# other.
+TIMEFORMAT=%R
+PASS=tests/llvm-pass-skeleton/build/LCM/LCMPass.so
+OPT="opt -load ${PASS} -load-pass-plugin ${PASS} -passes=function(mem2reg),default<O0>"
+for n in 4000 8000 16000; do
+    src=large_cfg_${n}.c
+    {
+        echo "int f(int *v, int s) {"
+        echo "    switch (s) {"
+        for i in $(seq 0 $((n - 1))); do
+            echo "    case ${i}: v[$((i % 64))] = v[$((i * 7 % 64))] + v[$(((i * 13 + 1) % 64))]; break;"
+        done
+        echo "    }"
+        echo "    return v[0];"
+        echo "}"
+    } > ${src}
+    clang -O0 -Xclang -disable-O0-optnone -S -emit-llvm -o ${src%.c}.ll ${src}
+    cands=$(${OPT} -lcm-stats -disable-output ${src%.c}.ll 2>&1 \
+        | sed -n 's/^LCM stats f: .* \([0-9]*\) candidates.*/\1/p')
+    echo "${n} states (${cands} candidates):"
+    for t in 1 0; do
+        time=$( { time ${OPT} -lcm-threads=${t} -disable-output ${src%.c}.ll 2>/dev/null; } 2>&1 )
+        echo "    -lcm-threads=${t}: ${time}s"
+    done
+    for c in true false; do
+        solves=$(${OPT} -lcm-threads=0 -lcm-concurrent-solves=${c} -lcm-time -disable-output ${src%.c}.ll 2>&1 \
+            | sed -n 's/^LCM times f.*avail+antic \([0-9]*\),.*/\1/p')
+        echo "    -lcm-threads=0 -lcm-concurrent-solves=${c}: avail+antic ${solves} us"
+    done
+    rm -f ${src} ${src%.c}.ll
+done
@@ -0,0 +1,33 @@
+; Only an expression computed twice, or once on a cycle, is a candidate; a
+; function without candidates is left alone.
+; RUN: %lcm -lcm-stats -S %s 2>&1 | FileCheck %s
+
+; CHECK: LCM stats straight: 1 blocks, 0 edges, 2 exprs, 0 candidates
+; CHECK: LCM stats looped: 3 blocks, 3 edges, 4 exprs, 3 candidates
+
+; CHECK-LABEL: @straight(
+; CHECK-NEXT:  entry:
+; CHECK-NEXT:    %x = add i32 %a, %b
+; CHECK-NEXT:    %y = mul i32 %x, %a
+; CHECK-NEXT:    ret i32 %y
+define i32 @straight(i32 %a, i32 %b) {
+entry:
+  %x = add i32 %a, %b
+  %y = mul i32 %x, %a
+  ret i32 %y
+}
+
+define i32 @looped(i32 %a, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %x = shl i32 %a, 2
+  %i.next = add i32 %i, %x
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %i.next
+}
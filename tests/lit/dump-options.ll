@@ -0,0 +1,17 @@
+; The set dump (-lcm-dump-sets) stores every set at once, so the options
+; that would not are ignored while it is on, with a warning.
+; RUN: %lcm_dump -lcm-lean -lcm-chunk-exprs=64 -lcm-formulation=node -disable-output %s 2>&1 \
+; RUN:   | FileCheck %s
+; RUN: %lcm -lcm-lean -lcm-chunk-exprs=64 -lcm-formulation=node -disable-output %s 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=OFF --allow-empty
+
+; CHECK: warning: -lcm-chunk-exprs is ignored with -lcm-dump-sets
+; CHECK: warning: -lcm-lean is ignored with -lcm-dump-sets
+; CHECK: warning: -lcm-formulation=node is ignored with -lcm-dump-sets
+; OFF-NOT: warning
+
+define i32 @f(i32 %a, i32 %b) {
+entry:
+  %x = add i32 %a, %b
+  ret i32 %x
+}
@@ -0,0 +1,62 @@
+; Where the block splitting a critical edge goes. Without branch weights, it
+; goes where no fallthrough is lost (see @critical in partial-redundancy.ll);
+; with them, the hot edge falls through into its new block, and the new
+; block of a cold edge goes to the end of the function.
+; RUN: %lcm -S %s | FileCheck %s
+
+; The split edge is the hot one: its block comes right after entry, although
+; entry fell through into then.
+; CHECK-LABEL: @hot(
+; CHECK:       entry:
+; CHECK-NEXT:    br i1 %c, label %then, label %[[SPLIT:newblock[0-9]+]]
+; CHECK-EMPTY:
+; CHECK-NEXT:  {{^}}[[SPLIT]]:
+; CHECK-NEXT:    [[Y:%.*]] = add i32 %a, %b
+; CHECK-NEXT:    br label %join
+; CHECK-EMPTY:
+; CHECK-NEXT:  {{^}}then:
+; CHECK:       join:
+; CHECK-NEXT:    phi i32 [ [[Y]], %[[SPLIT]] ], [ %x, %then ]
+define i32 @hot(i1 %c, i32 %a, i32 %b) {
+entry:
+  br i1 %c, label %then, label %join, !prof !0
+
+then:
+  %x = add i32 %a, %b
+  br label %join
+
+join:
+  %y = add i32 %a, %b
+  ret i32 %y
+}
+
+; The split edge is the cold one: its block goes to the end, not between
+; entry and join, where it would cost nothing without the weights.
+; CHECK-LABEL: @cold(
+; CHECK:       entry:
+; CHECK-NEXT:    br i1 %c, label %then, label %[[SPLIT:newblock[0-9]+]]
+; CHECK-EMPTY:
+; CHECK-NEXT:  {{^}}join:
+; CHECK:       then:
+; CHECK-NEXT:    %x = add i32 %a, %b
+; CHECK-NEXT:    br label %join
+; CHECK-EMPTY:
+; CHECK-NEXT:  {{^}}[[SPLIT]]:
+; CHECK-NEXT:    add i32 %a, %b
+; CHECK-NEXT:    br label %join
+; CHECK-NEXT:  }
+define i32 @cold(i1 %c, i32 %a, i32 %b) {
+entry:
+  br i1 %c, label %then, label %join, !prof !1
+
+join:
+  %y = add i32 %a, %b
+  ret i32 %y
+
+then:
+  %x = add i32 %a, %b
+  br label %join
+}
+
+!0 = !{!"branch_weights", i32 1, i32 100}
+!1 = !{!"branch_weights", i32 100, i32 1}
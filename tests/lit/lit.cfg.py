@@ -0,0 +1,28 @@
+# lit configuration for the IR tests of the LCM pass: each .ll runs opt with
+# the plugin and checks the output with FileCheck.
+#   $ lit tests/lit
+# The plugin is looked up where tests/build_skeleton.sh builds it, or taken
+# from LCM_PLUGIN; opt and FileCheck from LLVM_BINDIR or llvm-config.
+import os
+import subprocess
+
+import lit.formats
+
+config.name = 'LCMPass'
+config.test_format = lit.formats.ShTest(True)
+config.suffixes = ['.ll']
+config.test_source_root = os.path.dirname(__file__)
+config.test_exec_root = config.test_source_root
+
+plugin = os.environ.get('LCM_PLUGIN', os.path.join(
+    config.test_source_root, '..', 'llvm-pass-skeleton', 'build', 'LCM', 'LCMPass.so'))
+bindir = os.environ.get('LLVM_BINDIR')
+if not bindir:
+    bindir = subprocess.check_output(['llvm-config', '--bindir'], text=True).strip()
+config.environment['PATH'] = os.pathsep.join([bindir, os.environ.get('PATH', '')])
+
+# opt with the pass in its O0 pipeline, with the set dump on, and off (the
+# default). %lcm_dump goes first: %lcm is a prefix of it.
+opt_lcm = "opt -load {0} -load-pass-plugin {0} -passes='default<O0>'".format(plugin)
+config.substitutions.append(('%lcm_dump', opt_lcm + ' -lcm-dump-sets'))
+config.substitutions.append(('%lcm', opt_lcm))
@@ -0,0 +1,48 @@
+; A loop-invariant expression moves to the edge into the loop. One whose
+; operand the loop redefines (ExprKill) stays.
+; RUN: %lcm -S %s | FileCheck %s
+
+; CHECK-LABEL: @invariant(
+; CHECK:       entry:
+; CHECK-NEXT:    [[X:%.*]] = mul i32 %a, %b
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK-NOT:     mul
+; CHECK:         %s.next = add i32 %s, [[X]]
+define i32 @invariant(i32 %a, i32 %b, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %x = mul i32 %a, %b
+  %s.next = add i32 %s, %x
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+; CHECK-LABEL: @redefined(
+; CHECK:       entry:
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK:         %x = mul i32 %i, %a
+; CHECK-NEXT:    %i.next = add i32 %i, %x
+define i32 @redefined(i32 %a, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %x = mul i32 %i, %a
+  %i.next = add i32 %i, %x
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %x
+}
@@ -0,0 +1,124 @@
+; Without alias information, any write to memory may change what a load
+; reads: a store to another pointer and a call both keep the load in the
+; loop, and so does a call whose result feeds an expression. A load in a
+; loop that does not write to memory moves out of it.
+; RUN: %lcm -S %s | FileCheck %s
+
+declare void @clobber(ptr)
+declare i32 @get()
+
+; CHECK-LABEL: @store_other(
+; CHECK:       entry:
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK:         %v = load i32, ptr %p
+; CHECK:         store i32 %i, ptr %q
+define i32 @store_other(ptr %p, ptr %q, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %v = load i32, ptr %p
+  %s.next = add i32 %s, %v
+  store i32 %i, ptr %q
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+; CHECK-LABEL: @call_clobbers(
+; CHECK:       entry:
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK:         %v = load i32, ptr %p
+; CHECK:         call void @clobber(ptr %p)
+define i32 @call_clobbers(ptr %p, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %v = load i32, ptr %p
+  %s.next = add i32 %s, %v
+  call void @clobber(ptr %p)
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+; CHECK-LABEL: @call_result(
+; CHECK:       loop:
+; CHECK:         %r = call i32 @get()
+; CHECK-NEXT:    %x = add i32 %r, 1
+define i32 @call_result(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %r = call i32 @get()
+  %x = add i32 %r, 1
+  %s.next = add i32 %s, %x
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+; CHECK-LABEL: @read_only(
+; CHECK:       entry:
+; CHECK-NEXT:    [[V:%.*]] = load i32, ptr %p
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK-NOT:     load
+; CHECK:         %s.next = add i32 %s, [[V]]
+define i32 @read_only(ptr %p, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %v = load i32, ptr %p
+  %s.next = add i32 %s, %v
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+; CHECK-LABEL: @volatile_load(
+; CHECK:       entry:
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK:         %v = load volatile i32, ptr %p
+define i32 @volatile_load(ptr %p, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %v = load volatile i32, ptr %p
+  %s.next = add i32 %s, %v
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s.next
+}
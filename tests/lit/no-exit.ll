@@ -0,0 +1,106 @@
+; Blocks that cannot reach an exit anticipate nothing past their own
+; occurrences: Antic starts there from {}, like at a return. Starting them
+; from the top would anticipate everything on a path into a loop without
+; exit, and move expressions onto it that it never evaluated. Blocks the
+; entry does not reach are solved like the rest of the function.
+; RUN: %lcm -S %s | FileCheck %s
+; RUN: %lcm -lcm-solver=scc -S %s | FileCheck %s
+; RUN: %lcm -lcm-solver=elim -S %s | FileCheck %s
+; RUN: %lcm -lcm-formulation=node -S %s | FileCheck %s
+
+; Nothing to move: %x depends on the PHI.
+; CHECK-LABEL: @counter(
+; CHECK:       entry:
+; CHECK-NEXT:    br i1 %c, label %loop, label %exit
+; CHECK:       body:
+; CHECK-NEXT:    %x = add i32 %phi, 1
+define void @counter(i1 %c, ptr %p) {
+entry:
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %phi = phi i32 [ 0, %entry ], [ %x, %body ]
+  br label %body
+
+body:
+  %x = add i32 %phi, 1
+  store volatile i32 %x, ptr %p
+  br label %loop
+
+exit:
+  ret void
+}
+
+; An invariant expression of a loop without exit stays in it: nothing is
+; anticipated at the loop, so there is no edge in front of it to insert on.
+; CHECK-LABEL: @invariant(
+; CHECK:       entry:
+; CHECK-NEXT:    br i1 %c, label %loop, label %exit
+; CHECK:       body:
+; CHECK-NEXT:    %m = mul i32 %a, %b
+; CHECK-NEXT:    store volatile i32 %m, ptr %p
+define void @invariant(i1 %c, i32 %a, i32 %b, ptr %p) {
+entry:
+  br i1 %c, label %loop, label %exit
+
+loop:
+  br label %body
+
+body:
+  %m = mul i32 %a, %b
+  store volatile i32 %m, ptr %p
+  br label %loop
+
+exit:
+  ret void
+}
+
+; The sdiv is anticipated on one successor of entry only; the other leads
+; into a loop without exit. It must not be inserted on that path, where it
+; could trap.
+; CHECK-LABEL: @partial_entry(
+; CHECK:       entry:
+; CHECK-NEXT:    br i1 %c, label %then, label %else
+; CHECK:       then:
+; CHECK-NEXT:    %d = sdiv i32 %a, %b
+; CHECK-NEXT:    ret i32 %d
+; CHECK:       else:
+; CHECK-NOT:     sdiv
+; CHECK:       }
+define i32 @partial_entry(i1 %c, i32 %a, i32 %b, ptr %p) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  %d = sdiv i32 %a, %b
+  ret i32 %d
+
+else:
+  br label %spin
+
+spin:
+  store volatile i32 0, ptr %p
+  br label %spin
+}
+
+; A self loop the entry does not reach: the solves terminate, and nothing
+; moves.
+; CHECK-LABEL: @unreachable_loop(
+; CHECK:       dead:
+; CHECK-NEXT:    %v = load i32, ptr %p
+; CHECK-NEXT:    %w = add i32 %v, 1
+; CHECK-NEXT:    store i32 %w, ptr %p
+define i32 @unreachable_loop(ptr %p) {
+entry:
+  ret i32 0
+
+dead:
+  %v = load i32, ptr %p
+  %w = add i32 %v, 1
+  store i32 %w, ptr %p
+  %c = icmp eq i32 %v, 0
+  br i1 %c, label %dead, label %out
+
+out:
+  ret i32 %w
+}
@@ -0,0 +1,51 @@
+; An expression computed on one path into a block and again in the block is
+; inserted on the other path, and the block reads a PHI of the two. A
+; critical edge that needs the insertion is split.
+; RUN: %lcm -S %s | FileCheck %s
+
+; CHECK-LABEL: @diamond(
+; CHECK:       then:
+; CHECK-NEXT:    %x = add i32 %a, %b
+; CHECK:       else:
+; CHECK-NEXT:    [[Y:%.*]] = add i32 %a, %b
+; CHECK-NEXT:    br label %join
+; CHECK:       join:
+; CHECK-NEXT:    [[P:%.*]] = phi i32 [ [[Y]], %else ], [ %x, %then ]
+; CHECK-NEXT:    ret i32 [[P]]
+define i32 @diamond(i1 %c, i32 %a, i32 %b) {
+entry:
+  br i1 %c, label %then, label %else
+
+then:
+  %x = add i32 %a, %b
+  br label %join
+
+else:
+  br label %join
+
+join:
+  %y = add i32 %a, %b
+  ret i32 %y
+}
+
+; CHECK-LABEL: @critical(
+; CHECK:       entry:
+; CHECK-NEXT:    br i1 %c, label %then, label %[[SPLIT:newblock[0-9]+]]
+; CHECK:       join:
+; CHECK-NEXT:    [[P:%.*]] = phi i32 [ [[Y:%.*]], %[[SPLIT]] ], [ %x, %then ]
+; CHECK-NEXT:    ret i32 [[P]]
+; CHECK:       [[SPLIT]]:
+; CHECK-NEXT:    [[Y]] = add i32 %a, %b
+; CHECK-NEXT:    br label %join
+define i32 @critical(i1 %c, i32 %a, i32 %b) {
+entry:
+  br i1 %c, label %then, label %join
+
+then:
+  %x = add i32 %a, %b
+  br label %join
+
+join:
+  %y = add i32 %a, %b
+  ret i32 %y
+}
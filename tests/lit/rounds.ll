@@ -0,0 +1,79 @@
+; Expressions are identified by their operands, so t * c over a moved t is
+; only the same expression in every block once they all read t's
+; temporary: a single round hoists t and leaves t * c in the loop, a
+; second round (within the default of 3) hoists t * c after it.
+; RUN: %lcm -lcm-rounds=1 -S %s | FileCheck %s --check-prefix=ONE
+; RUN: %lcm -lcm-rounds=2 -S %s | FileCheck %s --check-prefix=TWO
+; RUN: %lcm -S %s | FileCheck %s --check-prefix=TWO
+
+; ONE-LABEL: @tree(
+; ONE:       entry:
+; ONE-NEXT:    [[T:%.*]] = add i32 %a, %b
+; ONE-NEXT:    br label %loop
+; ONE:       loop:
+; ONE:         %m = mul i32 [[T]], %c
+; TWO-LABEL: @tree(
+; TWO:       entry:
+; TWO-NEXT:    [[T:%.*]] = add i32 %a, %b
+; TWO-NEXT:    [[M:%.*]] = mul i32 [[T]], %c
+; TWO-NEXT:    br label %loop
+; TWO:       loop:
+; TWO-NOT:     mul
+; TWO:         %s.next = add i32 %s, [[M]]
+define i32 @tree(i32 %a, i32 %b, i32 %c, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %t = add i32 %a, %b
+  %m = mul i32 %t, %c
+  %s.next = add i32 %s, %m
+  %i.next = add i32 %i, 1
+  %cond = icmp slt i32 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+; The first round splits l -> j for m2 = t1 * c, which l only computes as
+; t3 * c. Once t3 reads t1, the second round finds the copy in the split
+; block redundant with m3 and deletes it; the emptied block is removed, and
+; l branches to j again.
+; ONE-LABEL: @fold(
+; ONE:       l:
+; ONE:         br i1 %c2, label %[[SPLIT:newblock[0-9]+]], label %k
+; ONE:       {{^}}[[SPLIT]]:
+; ONE-NEXT:    mul i32 %t1, %c
+; TWO-LABEL: @fold(
+; TWO:       l:
+; TWO-NEXT:    %m3 = mul i32 %t1, %c
+; TWO-NEXT:    store i32 %m3, ptr %p
+; TWO-NEXT:    br i1 %c2, label %j, label %k
+; TWO-NOT:     newblock
+; TWO:       j:
+; TWO-NEXT:    phi i32 [ %m3, %l ], [ %m1, %x ]
+define i32 @fold(i1 %c1, i1 %c2, i32 %a, i32 %b, i32 %c, ptr %p) {
+entry:
+  %t1 = add i32 %a, %b
+  br i1 %c1, label %x, label %l
+
+x:
+  %m1 = mul i32 %t1, %c
+  br label %j
+
+l:
+  %t3 = add i32 %a, %b
+  %m3 = mul i32 %t3, %c
+  store i32 %m3, ptr %p
+  br i1 %c2, label %j, label %k
+
+j:
+  %m2 = mul i32 %t1, %c
+  ret i32 %m2
+
+k:
+  ret i32 0
+}
@@ -0,0 +1,49 @@
+; Every solver, set layout and formulation moves the same code.
+; RUN: %lcm -S %s | FileCheck %s
+; RUN: %lcm -lcm-solver=scc -S %s | FileCheck %s
+; RUN: %lcm -lcm-solver=elim -S %s | FileCheck %s
+; RUN: %lcm -lcm-lean -S %s | FileCheck %s
+; RUN: %lcm -lcm-formulation=node -S %s | FileCheck %s
+; RUN: %lcm -lcm-chunk-exprs=1 -S %s | FileCheck %s
+; RUN: %lcm -lcm-threads=4 -lcm-parallel-blocks=1 -lcm-parallel-grain=1 -S %s | FileCheck %s
+
+; The loop body is a diamond: a + b is computed on one side and after the
+; join, a * b after the join. Both move out of the loop, and the copy of
+; a + b on the side is deleted as well.
+
+; CHECK-LABEL: @loop_diamond(
+; CHECK:       entry:
+; CHECK-NEXT:    [[X:%.*]] = add i32 %a, %b
+; CHECK-NEXT:    [[M:%.*]] = mul i32 %a, %b
+; CHECK-NEXT:    br label %head
+; CHECK-NOT:     add i32 %a, %b
+; CHECK-NOT:     mul i32 %a, %b
+; CHECK:         %s.next = add i32 %s, [[X]]
+; CHECK-NEXT:    %t.next = add i32 %t, [[M]]
+define i32 @loop_diamond(i1 %c, i32 %a, i32 %b, i32 %n) {
+entry:
+  br label %head
+
+head:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %latch ]
+  %t = phi i32 [ 0, %entry ], [ %t.next, %latch ]
+  br i1 %c, label %then, label %latch
+
+then:
+  %x = add i32 %a, %b
+  br label %latch
+
+latch:
+  %y = add i32 %a, %b
+  %m = mul i32 %a, %b
+  %s.next = add i32 %s, %y
+  %t.next = add i32 %t, %m
+  %i.next = add i32 %i, 1
+  %d = icmp slt i32 %i.next, %n
+  br i1 %d, label %head, label %exit
+
+exit:
+  %r = add i32 %s.next, %t.next
+  ret i32 %r
+}
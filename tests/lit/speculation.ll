@@ -0,0 +1,56 @@
+; A call that may not return ends the path for what follows it: an
+; expression that may trap is not anticipated above it, so it is not
+; hoisted out of a loop where the call comes first. One that cannot trap is.
+; RUN: %lcm -S %s | FileCheck %s
+; RUN: %lcm -lcm-formulation=node -S %s | FileCheck %s
+
+declare void @maybe_exit()
+
+; CHECK-LABEL: @may_trap(
+; CHECK:       entry:
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK:         call void @maybe_exit()
+; CHECK-NEXT:    %x = sdiv i32 %a, %b
+define i32 @may_trap(i32 %a, i32 %b, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s1, %loop ]
+  call void @maybe_exit()
+  %x = sdiv i32 %a, %b
+  %s1 = add i32 %s, %x
+  %i1 = add i32 %i, 1
+  %c = icmp slt i32 %i1, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s1
+}
+
+; CHECK-LABEL: @cannot_trap(
+; CHECK:       entry:
+; CHECK-NEXT:    [[X:%.*]] = mul i32 %a, %b
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK:         call void @maybe_exit()
+; CHECK-NEXT:    %s1 = add i32 %s, [[X]]
+define i32 @cannot_trap(i32 %a, i32 %b, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s1, %loop ]
+  call void @maybe_exit()
+  %x = mul i32 %a, %b
+  %s1 = add i32 %s, %x
+  %i1 = add i32 %i, 1
+  %c = icmp slt i32 %i1, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s1
+}
@@ -0,0 +1,638 @@
+; A loop with 300 invariant expressions; with the running sums there are
+; over 600 candidates, more than the 256 the fixed-width kernels take, so
+; the rows go through the generic word loop (and its vector part, when the
+; pass is built for AVX2 or AVX-512). Every invariant expression leaves the
+; loop. Generated: the body adds %a + k for k = 1 .. 300 to a running sum.
+; With -lcm-chunk-exprs=64 the candidates are solved in 10 chunks of up to
+; 64 (3 avail visits each), whose Insert and Delete collect in one row.
+; RUN: %lcm -S %s | FileCheck %s
+; RUN: %lcm -lcm-fixed-width=false -S %s | FileCheck %s
+; RUN: %lcm -lcm-chunk-exprs=64 -S %s | FileCheck %s
+; RUN: %lcm -lcm-chunk-exprs=64 -lcm-lean -lcm-formulation=node -S %s | FileCheck %s
+; RUN: %lcm -lcm-chunk-exprs=64 -lcm-stats -disable-output %s 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=STATS
+
+; STATS: LCM stats wide: {{.*}} 602 candidates{{.*}} visits: avail 30,
+
+; CHECK-LABEL: @wide(
+; CHECK:       entry:
+; CHECK-NEXT:    add i32 %a, 1
+; CHECK:         add i32 %a, 300
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK-NOT:     add i32 %a,
+; CHECK:         ret i32
+define i32 @wide(i32 %a, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s300, %loop ]
+  %x1 = add i32 %a, 1
+  %s1 = add i32 %s, %x1
+  %x2 = add i32 %a, 2
+  %s2 = add i32 %s1, %x2
+  %x3 = add i32 %a, 3
+  %s3 = add i32 %s2, %x3
+  %x4 = add i32 %a, 4
+  %s4 = add i32 %s3, %x4
+  %x5 = add i32 %a, 5
+  %s5 = add i32 %s4, %x5
+  %x6 = add i32 %a, 6
+  %s6 = add i32 %s5, %x6
+  %x7 = add i32 %a, 7
+  %s7 = add i32 %s6, %x7
+  %x8 = add i32 %a, 8
+  %s8 = add i32 %s7, %x8
+  %x9 = add i32 %a, 9
+  %s9 = add i32 %s8, %x9
+  %x10 = add i32 %a, 10
+  %s10 = add i32 %s9, %x10
+  %x11 = add i32 %a, 11
+  %s11 = add i32 %s10, %x11
+  %x12 = add i32 %a, 12
+  %s12 = add i32 %s11, %x12
+  %x13 = add i32 %a, 13
+  %s13 = add i32 %s12, %x13
+  %x14 = add i32 %a, 14
+  %s14 = add i32 %s13, %x14
+  %x15 = add i32 %a, 15
+  %s15 = add i32 %s14, %x15
+  %x16 = add i32 %a, 16
+  %s16 = add i32 %s15, %x16
+  %x17 = add i32 %a, 17
+  %s17 = add i32 %s16, %x17
+  %x18 = add i32 %a, 18
+  %s18 = add i32 %s17, %x18
+  %x19 = add i32 %a, 19
+  %s19 = add i32 %s18, %x19
+  %x20 = add i32 %a, 20
+  %s20 = add i32 %s19, %x20
+  %x21 = add i32 %a, 21
+  %s21 = add i32 %s20, %x21
+  %x22 = add i32 %a, 22
+  %s22 = add i32 %s21, %x22
+  %x23 = add i32 %a, 23
+  %s23 = add i32 %s22, %x23
+  %x24 = add i32 %a, 24
+  %s24 = add i32 %s23, %x24
+  %x25 = add i32 %a, 25
+  %s25 = add i32 %s24, %x25
+  %x26 = add i32 %a, 26
+  %s26 = add i32 %s25, %x26
+  %x27 = add i32 %a, 27
+  %s27 = add i32 %s26, %x27
+  %x28 = add i32 %a, 28
+  %s28 = add i32 %s27, %x28
+  %x29 = add i32 %a, 29
+  %s29 = add i32 %s28, %x29
+  %x30 = add i32 %a, 30
+  %s30 = add i32 %s29, %x30
+  %x31 = add i32 %a, 31
+  %s31 = add i32 %s30, %x31
+  %x32 = add i32 %a, 32
+  %s32 = add i32 %s31, %x32
+  %x33 = add i32 %a, 33
+  %s33 = add i32 %s32, %x33
+  %x34 = add i32 %a, 34
+  %s34 = add i32 %s33, %x34
+  %x35 = add i32 %a, 35
+  %s35 = add i32 %s34, %x35
+  %x36 = add i32 %a, 36
+  %s36 = add i32 %s35, %x36
+  %x37 = add i32 %a, 37
+  %s37 = add i32 %s36, %x37
+  %x38 = add i32 %a, 38
+  %s38 = add i32 %s37, %x38
+  %x39 = add i32 %a, 39
+  %s39 = add i32 %s38, %x39
+  %x40 = add i32 %a, 40
+  %s40 = add i32 %s39, %x40
+  %x41 = add i32 %a, 41
+  %s41 = add i32 %s40, %x41
+  %x42 = add i32 %a, 42
+  %s42 = add i32 %s41, %x42
+  %x43 = add i32 %a, 43
+  %s43 = add i32 %s42, %x43
+  %x44 = add i32 %a, 44
+  %s44 = add i32 %s43, %x44
+  %x45 = add i32 %a, 45
+  %s45 = add i32 %s44, %x45
+  %x46 = add i32 %a, 46
+  %s46 = add i32 %s45, %x46
+  %x47 = add i32 %a, 47
+  %s47 = add i32 %s46, %x47
+  %x48 = add i32 %a, 48
+  %s48 = add i32 %s47, %x48
+  %x49 = add i32 %a, 49
+  %s49 = add i32 %s48, %x49
+  %x50 = add i32 %a, 50
+  %s50 = add i32 %s49, %x50
+  %x51 = add i32 %a, 51
+  %s51 = add i32 %s50, %x51
+  %x52 = add i32 %a, 52
+  %s52 = add i32 %s51, %x52
+  %x53 = add i32 %a, 53
+  %s53 = add i32 %s52, %x53
+  %x54 = add i32 %a, 54
+  %s54 = add i32 %s53, %x54
+  %x55 = add i32 %a, 55
+  %s55 = add i32 %s54, %x55
+  %x56 = add i32 %a, 56
+  %s56 = add i32 %s55, %x56
+  %x57 = add i32 %a, 57
+  %s57 = add i32 %s56, %x57
+  %x58 = add i32 %a, 58
+  %s58 = add i32 %s57, %x58
+  %x59 = add i32 %a, 59
+  %s59 = add i32 %s58, %x59
+  %x60 = add i32 %a, 60
+  %s60 = add i32 %s59, %x60
+  %x61 = add i32 %a, 61
+  %s61 = add i32 %s60, %x61
+  %x62 = add i32 %a, 62
+  %s62 = add i32 %s61, %x62
+  %x63 = add i32 %a, 63
+  %s63 = add i32 %s62, %x63
+  %x64 = add i32 %a, 64
+  %s64 = add i32 %s63, %x64
+  %x65 = add i32 %a, 65
+  %s65 = add i32 %s64, %x65
+  %x66 = add i32 %a, 66
+  %s66 = add i32 %s65, %x66
+  %x67 = add i32 %a, 67
+  %s67 = add i32 %s66, %x67
+  %x68 = add i32 %a, 68
+  %s68 = add i32 %s67, %x68
+  %x69 = add i32 %a, 69
+  %s69 = add i32 %s68, %x69
+  %x70 = add i32 %a, 70
+  %s70 = add i32 %s69, %x70
+  %x71 = add i32 %a, 71
+  %s71 = add i32 %s70, %x71
+  %x72 = add i32 %a, 72
+  %s72 = add i32 %s71, %x72
+  %x73 = add i32 %a, 73
+  %s73 = add i32 %s72, %x73
+  %x74 = add i32 %a, 74
+  %s74 = add i32 %s73, %x74
+  %x75 = add i32 %a, 75
+  %s75 = add i32 %s74, %x75
+  %x76 = add i32 %a, 76
+  %s76 = add i32 %s75, %x76
+  %x77 = add i32 %a, 77
+  %s77 = add i32 %s76, %x77
+  %x78 = add i32 %a, 78
+  %s78 = add i32 %s77, %x78
+  %x79 = add i32 %a, 79
+  %s79 = add i32 %s78, %x79
+  %x80 = add i32 %a, 80
+  %s80 = add i32 %s79, %x80
+  %x81 = add i32 %a, 81
+  %s81 = add i32 %s80, %x81
+  %x82 = add i32 %a, 82
+  %s82 = add i32 %s81, %x82
+  %x83 = add i32 %a, 83
+  %s83 = add i32 %s82, %x83
+  %x84 = add i32 %a, 84
+  %s84 = add i32 %s83, %x84
+  %x85 = add i32 %a, 85
+  %s85 = add i32 %s84, %x85
+  %x86 = add i32 %a, 86
+  %s86 = add i32 %s85, %x86
+  %x87 = add i32 %a, 87
+  %s87 = add i32 %s86, %x87
+  %x88 = add i32 %a, 88
+  %s88 = add i32 %s87, %x88
+  %x89 = add i32 %a, 89
+  %s89 = add i32 %s88, %x89
+  %x90 = add i32 %a, 90
+  %s90 = add i32 %s89, %x90
+  %x91 = add i32 %a, 91
+  %s91 = add i32 %s90, %x91
+  %x92 = add i32 %a, 92
+  %s92 = add i32 %s91, %x92
+  %x93 = add i32 %a, 93
+  %s93 = add i32 %s92, %x93
+  %x94 = add i32 %a, 94
+  %s94 = add i32 %s93, %x94
+  %x95 = add i32 %a, 95
+  %s95 = add i32 %s94, %x95
+  %x96 = add i32 %a, 96
+  %s96 = add i32 %s95, %x96
+  %x97 = add i32 %a, 97
+  %s97 = add i32 %s96, %x97
+  %x98 = add i32 %a, 98
+  %s98 = add i32 %s97, %x98
+  %x99 = add i32 %a, 99
+  %s99 = add i32 %s98, %x99
+  %x100 = add i32 %a, 100
+  %s100 = add i32 %s99, %x100
+  %x101 = add i32 %a, 101
+  %s101 = add i32 %s100, %x101
+  %x102 = add i32 %a, 102
+  %s102 = add i32 %s101, %x102
+  %x103 = add i32 %a, 103
+  %s103 = add i32 %s102, %x103
+  %x104 = add i32 %a, 104
+  %s104 = add i32 %s103, %x104
+  %x105 = add i32 %a, 105
+  %s105 = add i32 %s104, %x105
+  %x106 = add i32 %a, 106
+  %s106 = add i32 %s105, %x106
+  %x107 = add i32 %a, 107
+  %s107 = add i32 %s106, %x107
+  %x108 = add i32 %a, 108
+  %s108 = add i32 %s107, %x108
+  %x109 = add i32 %a, 109
+  %s109 = add i32 %s108, %x109
+  %x110 = add i32 %a, 110
+  %s110 = add i32 %s109, %x110
+  %x111 = add i32 %a, 111
+  %s111 = add i32 %s110, %x111
+  %x112 = add i32 %a, 112
+  %s112 = add i32 %s111, %x112
+  %x113 = add i32 %a, 113
+  %s113 = add i32 %s112, %x113
+  %x114 = add i32 %a, 114
+  %s114 = add i32 %s113, %x114
+  %x115 = add i32 %a, 115
+  %s115 = add i32 %s114, %x115
+  %x116 = add i32 %a, 116
+  %s116 = add i32 %s115, %x116
+  %x117 = add i32 %a, 117
+  %s117 = add i32 %s116, %x117
+  %x118 = add i32 %a, 118
+  %s118 = add i32 %s117, %x118
+  %x119 = add i32 %a, 119
+  %s119 = add i32 %s118, %x119
+  %x120 = add i32 %a, 120
+  %s120 = add i32 %s119, %x120
+  %x121 = add i32 %a, 121
+  %s121 = add i32 %s120, %x121
+  %x122 = add i32 %a, 122
+  %s122 = add i32 %s121, %x122
+  %x123 = add i32 %a, 123
+  %s123 = add i32 %s122, %x123
+  %x124 = add i32 %a, 124
+  %s124 = add i32 %s123, %x124
+  %x125 = add i32 %a, 125
+  %s125 = add i32 %s124, %x125
+  %x126 = add i32 %a, 126
+  %s126 = add i32 %s125, %x126
+  %x127 = add i32 %a, 127
+  %s127 = add i32 %s126, %x127
+  %x128 = add i32 %a, 128
+  %s128 = add i32 %s127, %x128
+  %x129 = add i32 %a, 129
+  %s129 = add i32 %s128, %x129
+  %x130 = add i32 %a, 130
+  %s130 = add i32 %s129, %x130
+  %x131 = add i32 %a, 131
+  %s131 = add i32 %s130, %x131
+  %x132 = add i32 %a, 132
+  %s132 = add i32 %s131, %x132
+  %x133 = add i32 %a, 133
+  %s133 = add i32 %s132, %x133
+  %x134 = add i32 %a, 134
+  %s134 = add i32 %s133, %x134
+  %x135 = add i32 %a, 135
+  %s135 = add i32 %s134, %x135
+  %x136 = add i32 %a, 136
+  %s136 = add i32 %s135, %x136
+  %x137 = add i32 %a, 137
+  %s137 = add i32 %s136, %x137
+  %x138 = add i32 %a, 138
+  %s138 = add i32 %s137, %x138
+  %x139 = add i32 %a, 139
+  %s139 = add i32 %s138, %x139
+  %x140 = add i32 %a, 140
+  %s140 = add i32 %s139, %x140
+  %x141 = add i32 %a, 141
+  %s141 = add i32 %s140, %x141
+  %x142 = add i32 %a, 142
+  %s142 = add i32 %s141, %x142
+  %x143 = add i32 %a, 143
+  %s143 = add i32 %s142, %x143
+  %x144 = add i32 %a, 144
+  %s144 = add i32 %s143, %x144
+  %x145 = add i32 %a, 145
+  %s145 = add i32 %s144, %x145
+  %x146 = add i32 %a, 146
+  %s146 = add i32 %s145, %x146
+  %x147 = add i32 %a, 147
+  %s147 = add i32 %s146, %x147
+  %x148 = add i32 %a, 148
+  %s148 = add i32 %s147, %x148
+  %x149 = add i32 %a, 149
+  %s149 = add i32 %s148, %x149
+  %x150 = add i32 %a, 150
+  %s150 = add i32 %s149, %x150
+  %x151 = add i32 %a, 151
+  %s151 = add i32 %s150, %x151
+  %x152 = add i32 %a, 152
+  %s152 = add i32 %s151, %x152
+  %x153 = add i32 %a, 153
+  %s153 = add i32 %s152, %x153
+  %x154 = add i32 %a, 154
+  %s154 = add i32 %s153, %x154
+  %x155 = add i32 %a, 155
+  %s155 = add i32 %s154, %x155
+  %x156 = add i32 %a, 156
+  %s156 = add i32 %s155, %x156
+  %x157 = add i32 %a, 157
+  %s157 = add i32 %s156, %x157
+  %x158 = add i32 %a, 158
+  %s158 = add i32 %s157, %x158
+  %x159 = add i32 %a, 159
+  %s159 = add i32 %s158, %x159
+  %x160 = add i32 %a, 160
+  %s160 = add i32 %s159, %x160
+  %x161 = add i32 %a, 161
+  %s161 = add i32 %s160, %x161
+  %x162 = add i32 %a, 162
+  %s162 = add i32 %s161, %x162
+  %x163 = add i32 %a, 163
+  %s163 = add i32 %s162, %x163
+  %x164 = add i32 %a, 164
+  %s164 = add i32 %s163, %x164
+  %x165 = add i32 %a, 165
+  %s165 = add i32 %s164, %x165
+  %x166 = add i32 %a, 166
+  %s166 = add i32 %s165, %x166
+  %x167 = add i32 %a, 167
+  %s167 = add i32 %s166, %x167
+  %x168 = add i32 %a, 168
+  %s168 = add i32 %s167, %x168
+  %x169 = add i32 %a, 169
+  %s169 = add i32 %s168, %x169
+  %x170 = add i32 %a, 170
+  %s170 = add i32 %s169, %x170
+  %x171 = add i32 %a, 171
+  %s171 = add i32 %s170, %x171
+  %x172 = add i32 %a, 172
+  %s172 = add i32 %s171, %x172
+  %x173 = add i32 %a, 173
+  %s173 = add i32 %s172, %x173
+  %x174 = add i32 %a, 174
+  %s174 = add i32 %s173, %x174
+  %x175 = add i32 %a, 175
+  %s175 = add i32 %s174, %x175
+  %x176 = add i32 %a, 176
+  %s176 = add i32 %s175, %x176
+  %x177 = add i32 %a, 177
+  %s177 = add i32 %s176, %x177
+  %x178 = add i32 %a, 178
+  %s178 = add i32 %s177, %x178
+  %x179 = add i32 %a, 179
+  %s179 = add i32 %s178, %x179
+  %x180 = add i32 %a, 180
+  %s180 = add i32 %s179, %x180
+  %x181 = add i32 %a, 181
+  %s181 = add i32 %s180, %x181
+  %x182 = add i32 %a, 182
+  %s182 = add i32 %s181, %x182
+  %x183 = add i32 %a, 183
+  %s183 = add i32 %s182, %x183
+  %x184 = add i32 %a, 184
+  %s184 = add i32 %s183, %x184
+  %x185 = add i32 %a, 185
+  %s185 = add i32 %s184, %x185
+  %x186 = add i32 %a, 186
+  %s186 = add i32 %s185, %x186
+  %x187 = add i32 %a, 187
+  %s187 = add i32 %s186, %x187
+  %x188 = add i32 %a, 188
+  %s188 = add i32 %s187, %x188
+  %x189 = add i32 %a, 189
+  %s189 = add i32 %s188, %x189
+  %x190 = add i32 %a, 190
+  %s190 = add i32 %s189, %x190
+  %x191 = add i32 %a, 191
+  %s191 = add i32 %s190, %x191
+  %x192 = add i32 %a, 192
+  %s192 = add i32 %s191, %x192
+  %x193 = add i32 %a, 193
+  %s193 = add i32 %s192, %x193
+  %x194 = add i32 %a, 194
+  %s194 = add i32 %s193, %x194
+  %x195 = add i32 %a, 195
+  %s195 = add i32 %s194, %x195
+  %x196 = add i32 %a, 196
+  %s196 = add i32 %s195, %x196
+  %x197 = add i32 %a, 197
+  %s197 = add i32 %s196, %x197
+  %x198 = add i32 %a, 198
+  %s198 = add i32 %s197, %x198
+  %x199 = add i32 %a, 199
+  %s199 = add i32 %s198, %x199
+  %x200 = add i32 %a, 200
+  %s200 = add i32 %s199, %x200
+  %x201 = add i32 %a, 201
+  %s201 = add i32 %s200, %x201
+  %x202 = add i32 %a, 202
+  %s202 = add i32 %s201, %x202
+  %x203 = add i32 %a, 203
+  %s203 = add i32 %s202, %x203
+  %x204 = add i32 %a, 204
+  %s204 = add i32 %s203, %x204
+  %x205 = add i32 %a, 205
+  %s205 = add i32 %s204, %x205
+  %x206 = add i32 %a, 206
+  %s206 = add i32 %s205, %x206
+  %x207 = add i32 %a, 207
+  %s207 = add i32 %s206, %x207
+  %x208 = add i32 %a, 208
+  %s208 = add i32 %s207, %x208
+  %x209 = add i32 %a, 209
+  %s209 = add i32 %s208, %x209
+  %x210 = add i32 %a, 210
+  %s210 = add i32 %s209, %x210
+  %x211 = add i32 %a, 211
+  %s211 = add i32 %s210, %x211
+  %x212 = add i32 %a, 212
+  %s212 = add i32 %s211, %x212
+  %x213 = add i32 %a, 213
+  %s213 = add i32 %s212, %x213
+  %x214 = add i32 %a, 214
+  %s214 = add i32 %s213, %x214
+  %x215 = add i32 %a, 215
+  %s215 = add i32 %s214, %x215
+  %x216 = add i32 %a, 216
+  %s216 = add i32 %s215, %x216
+  %x217 = add i32 %a, 217
+  %s217 = add i32 %s216, %x217
+  %x218 = add i32 %a, 218
+  %s218 = add i32 %s217, %x218
+  %x219 = add i32 %a, 219
+  %s219 = add i32 %s218, %x219
+  %x220 = add i32 %a, 220
+  %s220 = add i32 %s219, %x220
+  %x221 = add i32 %a, 221
+  %s221 = add i32 %s220, %x221
+  %x222 = add i32 %a, 222
+  %s222 = add i32 %s221, %x222
+  %x223 = add i32 %a, 223
+  %s223 = add i32 %s222, %x223
+  %x224 = add i32 %a, 224
+  %s224 = add i32 %s223, %x224
+  %x225 = add i32 %a, 225
+  %s225 = add i32 %s224, %x225
+  %x226 = add i32 %a, 226
+  %s226 = add i32 %s225, %x226
+  %x227 = add i32 %a, 227
+  %s227 = add i32 %s226, %x227
+  %x228 = add i32 %a, 228
+  %s228 = add i32 %s227, %x228
+  %x229 = add i32 %a, 229
+  %s229 = add i32 %s228, %x229
+  %x230 = add i32 %a, 230
+  %s230 = add i32 %s229, %x230
+  %x231 = add i32 %a, 231
+  %s231 = add i32 %s230, %x231
+  %x232 = add i32 %a, 232
+  %s232 = add i32 %s231, %x232
+  %x233 = add i32 %a, 233
+  %s233 = add i32 %s232, %x233
+  %x234 = add i32 %a, 234
+  %s234 = add i32 %s233, %x234
+  %x235 = add i32 %a, 235
+  %s235 = add i32 %s234, %x235
+  %x236 = add i32 %a, 236
+  %s236 = add i32 %s235, %x236
+  %x237 = add i32 %a, 237
+  %s237 = add i32 %s236, %x237
+  %x238 = add i32 %a, 238
+  %s238 = add i32 %s237, %x238
+  %x239 = add i32 %a, 239
+  %s239 = add i32 %s238, %x239
+  %x240 = add i32 %a, 240
+  %s240 = add i32 %s239, %x240
+  %x241 = add i32 %a, 241
+  %s241 = add i32 %s240, %x241
+  %x242 = add i32 %a, 242
+  %s242 = add i32 %s241, %x242
+  %x243 = add i32 %a, 243
+  %s243 = add i32 %s242, %x243
+  %x244 = add i32 %a, 244
+  %s244 = add i32 %s243, %x244
+  %x245 = add i32 %a, 245
+  %s245 = add i32 %s244, %x245
+  %x246 = add i32 %a, 246
+  %s246 = add i32 %s245, %x246
+  %x247 = add i32 %a, 247
+  %s247 = add i32 %s246, %x247
+  %x248 = add i32 %a, 248
+  %s248 = add i32 %s247, %x248
+  %x249 = add i32 %a, 249
+  %s249 = add i32 %s248, %x249
+  %x250 = add i32 %a, 250
+  %s250 = add i32 %s249, %x250
+  %x251 = add i32 %a, 251
+  %s251 = add i32 %s250, %x251
+  %x252 = add i32 %a, 252
+  %s252 = add i32 %s251, %x252
+  %x253 = add i32 %a, 253
+  %s253 = add i32 %s252, %x253
+  %x254 = add i32 %a, 254
+  %s254 = add i32 %s253, %x254
+  %x255 = add i32 %a, 255
+  %s255 = add i32 %s254, %x255
+  %x256 = add i32 %a, 256
+  %s256 = add i32 %s255, %x256
+  %x257 = add i32 %a, 257
+  %s257 = add i32 %s256, %x257
+  %x258 = add i32 %a, 258
+  %s258 = add i32 %s257, %x258
+  %x259 = add i32 %a, 259
+  %s259 = add i32 %s258, %x259
+  %x260 = add i32 %a, 260
+  %s260 = add i32 %s259, %x260
+  %x261 = add i32 %a, 261
+  %s261 = add i32 %s260, %x261
+  %x262 = add i32 %a, 262
+  %s262 = add i32 %s261, %x262
+  %x263 = add i32 %a, 263
+  %s263 = add i32 %s262, %x263
+  %x264 = add i32 %a, 264
+  %s264 = add i32 %s263, %x264
+  %x265 = add i32 %a, 265
+  %s265 = add i32 %s264, %x265
+  %x266 = add i32 %a, 266
+  %s266 = add i32 %s265, %x266
+  %x267 = add i32 %a, 267
+  %s267 = add i32 %s266, %x267
+  %x268 = add i32 %a, 268
+  %s268 = add i32 %s267, %x268
+  %x269 = add i32 %a, 269
+  %s269 = add i32 %s268, %x269
+  %x270 = add i32 %a, 270
+  %s270 = add i32 %s269, %x270
+  %x271 = add i32 %a, 271
+  %s271 = add i32 %s270, %x271
+  %x272 = add i32 %a, 272
+  %s272 = add i32 %s271, %x272
+  %x273 = add i32 %a, 273
+  %s273 = add i32 %s272, %x273
+  %x274 = add i32 %a, 274
+  %s274 = add i32 %s273, %x274
+  %x275 = add i32 %a, 275
+  %s275 = add i32 %s274, %x275
+  %x276 = add i32 %a, 276
+  %s276 = add i32 %s275, %x276
+  %x277 = add i32 %a, 277
+  %s277 = add i32 %s276, %x277
+  %x278 = add i32 %a, 278
+  %s278 = add i32 %s277, %x278
+  %x279 = add i32 %a, 279
+  %s279 = add i32 %s278, %x279
+  %x280 = add i32 %a, 280
+  %s280 = add i32 %s279, %x280
+  %x281 = add i32 %a, 281
+  %s281 = add i32 %s280, %x281
+  %x282 = add i32 %a, 282
+  %s282 = add i32 %s281, %x282
+  %x283 = add i32 %a, 283
+  %s283 = add i32 %s282, %x283
+  %x284 = add i32 %a, 284
+  %s284 = add i32 %s283, %x284
+  %x285 = add i32 %a, 285
+  %s285 = add i32 %s284, %x285
+  %x286 = add i32 %a, 286
+  %s286 = add i32 %s285, %x286
+  %x287 = add i32 %a, 287
+  %s287 = add i32 %s286, %x287
+  %x288 = add i32 %a, 288
+  %s288 = add i32 %s287, %x288
+  %x289 = add i32 %a, 289
+  %s289 = add i32 %s288, %x289
+  %x290 = add i32 %a, 290
+  %s290 = add i32 %s289, %x290
+  %x291 = add i32 %a, 291
+  %s291 = add i32 %s290, %x291
+  %x292 = add i32 %a, 292
+  %s292 = add i32 %s291, %x292
+  %x293 = add i32 %a, 293
+  %s293 = add i32 %s292, %x293
+  %x294 = add i32 %a, 294
+  %s294 = add i32 %s293, %x294
+  %x295 = add i32 %a, 295
+  %s295 = add i32 %s294, %x295
+  %x296 = add i32 %a, 296
+  %s296 = add i32 %s295, %x296
+  %x297 = add i32 %a, 297
+  %s297 = add i32 %s296, %x297
+  %x298 = add i32 %a, 298
+  %s298 = add i32 %s297, %x298
+  %x299 = add i32 %a, 299
+  %s299 = add i32 %s298, %x299
+  %x300 = add i32 %a, 300
+  %s300 = add i32 %s299, %x300
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s300
+}
@@ -0,0 +1,27 @@
+# Scaling test: compile generated functions of growing size, with and
+# without the LCMPass. The statements sit in a loop, so that every
+# expression is a candidate. The extra time spent in the pass should grow
+# about linearly with the number of statements.
+TIMEFORMAT=%R
+PASS=tests/llvm-pass-skeleton/build/LCM/LCMPass.so
+LCM="-fpass-plugin=${PASS}"
+for n in 1000 2000 4000 8000 16000; do
+    src=scaling_${n}.c
+    {
+        echo "int f(int *v, int a, int b, int n) {"
+        echo "    int s = 0;"
+        echo "    for (int k = 0; k < n; k++) {"
+        for i in $(seq 0 $((n - 1))); do
+            echo "        s += (a * $((i % 61 + 2)) + b) ^ v[(k + $((i % 64))) & 63];"
+        done
+        echo "    }"
+        echo "    return s;"
+        echo "}"
+    } > ${src}
+    cands=$(clang -c -o /dev/null ${LCM} -mllvm -lcm-stats ${src} 2>&1 \
+        | sed -n 's/^LCM stats f: .* \([0-9]*\) candidates.*/\1/p' | head -1)
+    base=$( { time clang -c -o /dev/null ${src} 2>/dev/null; } 2>&1 )
+    lcm=$( { time clang -c -o /dev/null ${LCM} ${src} 2>/dev/null; } 2>&1 )
+    echo "${n} statements (${cands} candidates): clang ${base}s, clang + LCMPass ${lcm}s"
+    rm -f ${src}
+done
@@ -0,0 +1,20 @@
+# Candidate pruning: for the single-source benchmarks of the test suite, sum
+# the expressions of every function and the candidates left in the
+# bit-vector universe after pruning, as printed by -lcm-stats.
+PASS=tests/llvm-pass-skeleton/build/LCM/LCMPass.so
+tmp=universe.ll
+total_exprs=0
+total_cands=0
+for src in $(find tests/test-suite/SingleSource/Benchmarks -name '*.c'); do
+    clang -O0 -Xclang -disable-O0-optnone -S -emit-llvm -w -o ${tmp} ${src} 2>/dev/null || continue
+    counts=$(opt -load ${PASS} -load-pass-plugin ${PASS} -passes='function(mem2reg),default<O0>' \
+        -lcm-stats -disable-output ${tmp} 2>&1 |
+        sed -n 's/^LCM stats .* \([0-9]*\) exprs, \([0-9]*\) candidates.*/\1 \2/p' |
+        awk '{ e += $1; c += $2 } END { print e + 0, c + 0 }')
+    set -- ${counts}
+    echo "${src}: $1 exprs, $2 candidates"
+    total_exprs=$((total_exprs + $1))
+    total_cands=$((total_cands + $2))
+done
+rm -f ${tmp}
+echo "total: ${total_exprs} exprs, ${total_cands} candidates"
@@ -0,0 +1,13 @@
+# The set kernels use vectors of 4 (AVX2) or 8 (AVX-512) words only when
+# the pass is compiled for such a target; the default build is scalar. Build
+# the pass with -mavx2 and with -mavx512f, each where this CPU has it, and
+# run the IR tests against each build (tests/lit/wide.ll has rows wide
+# enough for the vector loop).
+for flags in -mavx2 -mavx512f; do
+    if ! grep -qw ${flags#-m} /proc/cpuinfo; then
+        echo "${flags}: not supported by this CPU, skipped"
+        continue
+    fi
+    bash tests/build_skeleton.sh build${flags} ${flags} > /dev/null || exit 1
+    LCM_PLUGIN=tests/llvm-pass-skeleton/build${flags}/LCM/LCMPass.so lit tests/lit || exit 1
+done